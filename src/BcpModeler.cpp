@@ -12,6 +12,9 @@
 #include "BCP_lp_node.hpp"
 //#include "CbcModeler.h"
 #include "RotationPricer.h"
+#ifdef USE_CBC
+#include "CbcModel.hpp"
+#endif
 
 /*
  * BCP_lp_user methods
@@ -19,7 +22,7 @@
 
 BcpLpModel::BcpLpModel(BcpModeler* pModel):
 pModel_(pModel),nbCurrentColumnVarsBeforePricing_(pModel->getNbColumns()),
-lpIteration_(0), last_node(-1), heuristicHasBeenRun_(false)
+lpIteration_(0), last_node(-1), heuristicHasBeenRun_(false), rootBasisLoaded_(false), pLastNode_(0), rootStartTime_(0)
 { }
 
 //Initialize the lp parameters and the OsiSolver
@@ -44,6 +47,11 @@ BCP_solution* BcpLpModel::generate_heuristic_solution(const BCP_lp_result& lpres
    if(pModel_->getParameters().stopAfterXSolution_ == 0)
       return sol;
 
+   //solution found by the restricted master heuristic running in the background
+   sol = pModel_->runMipHeuristic();
+   if(sol)
+      return sol;
+
    //if heuristic has already been run in these node or
    //it has not been long enough since the last run or
    //the objective of the sub-problem is too negative
@@ -101,14 +109,11 @@ BCP_solution* BcpLpModel::generate_heuristic_solution(const BCP_lp_result& lpres
          for(int i=0; i<size; ++i)
             if(solver->getColSolution()[i] > EPSILON){
                //create new var that will be deleted by the solution sol
-               if(i<coreSize){
-                  BcpCoreVar* var0 = dynamic_cast<BcpCoreVar*>(pModel_->getCoreVars()[i]);
-                  sol->add_entry(new BcpCoreVar(*var0), solver->getColSolution()[i]);
-               }
-               else{
-                  BcpColumn* var0 = dynamic_cast<BcpColumn*>(vars[i]);
-                  sol->add_entry(new BcpColumn(*var0), solver->getColSolution()[i]);
-               }
+               if(i<coreSize)
+                  sol->add_entry(new BcpCoreVar(*pModel_->getBcpCoreVar(i)), solver->getColSolution()[i]);
+               else
+                  sol->add_entry(new BcpColumnRef(pModel_->getBcpColumn(pModel_->getVarIndex(vars, i))),
+                     solver->getColSolution()[i]);
             }
 
          break;
@@ -137,8 +142,31 @@ bool BcpLpModel::compareCol(const pair<int,double>& p1, const pair<int,double>&
 //The second argument indicates whether the optimization is a "regular" optimization or it will take place in strong branching.
 //Default: empty method.
 void BcpLpModel::modify_lp_parameters ( OsiSolverInterface* lp, const int changeType, bool in_strong_branching){
+   //warm start the root with the basis of the last solve: if it is a resolve, just the rhs have changed
+   if(current_index() == 0 && !rootBasisLoaded_){
+      rootBasisLoaded_ = true;
+      rootStartTime_ = CoinCpuTime();
+      BCP_lp_node* node = getLpProblemPointer()->node;
+      CoinWarmStartBasis* basis = pModel_->buildRootBasis(node->vars, node->cuts);
+      if(basis){
+         lp->setWarmStart(basis);
+         delete basis;
+      }
+   }
+
    if(current_index() != last_node){
       last_node = current_index();
+      //warm start a node which is not processed right after its parent with the basis of its parent
+      BcpNode* pNode = pModel_->getCurrentNode();
+      if(current_index() > 0 && !in_strong_branching && pNode->pParent_ != pLastNode_){
+         BCP_lp_node* node = getLpProblemPointer()->node;
+         CoinWarmStartBasis* basis = pModel_->buildParentBasis(node->vars, node->cuts);
+         if(basis){
+            lp->setWarmStart(basis);
+            delete basis;
+         }
+      }
+      pLastNode_ = pNode;
       printSummaryLine();
    }
 }
@@ -215,6 +243,8 @@ bool BcpLpModel::doStop(){
 //AS THE FINAL LP BOUND OF THE NODE IS GIVEN TO ITS CHILDREN,
 //FIXING WRONG BOUNDS CAN LEAD TO A FALSE LOWER BOUND, THUS FATHOMING WRONG NODES.
 ///////////////////////////////////////////////////////////////////////////////////////
+//Here, only the reduced cost fixing done at the end of the ancestors of the node are applied:
+//they exclude only the solutions that cannot improve the incumbent.
 void BcpLpModel::logical_fixing (const BCP_lp_result& lpres,
    const BCP_vec<BCP_var*>& vars,
    const BCP_vec<BCP_cut*>& cuts,
@@ -224,6 +254,21 @@ void BcpLpModel::logical_fixing (const BCP_lp_result& lpres,
    BCP_vec<int>& changed_pos,
    BCP_vec<double>& new_bd){
 
+   vector<bool> fixedVars;
+   if(!pModel_->getFixedVars(fixedVars))
+      return;
+
+   for(int i=0; i<vars.size(); ++i){
+      //already fixed or forced to be positive by a branching decision
+      if(vars[i]->ub() < EPSILON || vars[i]->lb() > EPSILON)
+         continue;
+      const int index = pModel_->getVarIndex(vars, i);
+      if(index < fixedVars.size() && fixedVars[index]){
+         changed_pos.push_back(i);
+         new_bd.push_back(0);
+         new_bd.push_back(0);
+      }
+   }
 }
 
 // Restoring feasibility.
@@ -259,22 +304,22 @@ void BcpLpModel::TransformVarsToColumns(BCP_vec<BCP_var*>& vars, BCP_vec<BCP_col
    cols.reserve(varnum);
 
    for (int i = 0; i < varnum; ++i) {
-      CoinVar* var = dynamic_cast<CoinVar*>(vars[i]);
-      if(!var)
+      //only the generated columns are expanded, the core variables are in the core matrix
+      if(vars[i]->obj_type() != BCP_AlgoObj)
          Tools::throwError("Bad variable casting.");
+      BcpColumn* var = pModel_->getBcpColumn(static_cast<BcpColumnRef*>(vars[i])->getIndex());
 
-      //Copy the vectors var->getIndexRows() and var->getCoeffRows() in arrays
+      //Copy the coefficients of the column from the contiguous storage of the modeler
+      //BCP_col takes the ownership of the arrays: no other copy is done
       const int size = var->getNbRows();
 
       //create a new array which will be deleted by ~BCP_col()
       int* indexRows = new int[size];
-      vector<int>& index = var->getIndexRows();
-      copy(index.begin(), index.end(), indexRows);
+      CoinDisjointCopyN(var->getIndexRows(), size, indexRows);
 
       //create a new array which will be deleted by ~BCP_col()
       double* coeffRows = new double[size];
-      vector<double>& coeffs = var->getCoeffRows();
-      copy(coeffs.begin(), coeffs.end(), coeffRows);
+      CoinDisjointCopyN(var->getCoeffRows(), size, coeffRows);
 
       cols.unchecked_push_back(
          new BCP_col(size, indexRows, coeffRows, var->getCost(), var->getLB(), var->getUB()) );
@@ -290,6 +335,8 @@ void BcpLpModel::generate_vars_in_lp(const BCP_lp_result& lpres,
       return;
 
    ++lpIteration_;
+   if(current_index() == 0)
+      pModel_->addRootLpIterations(lpres.iternum());
    pModel_->setLPSol(lpres, vars);
    pModel_->pricing(0, before_fathom);
 
@@ -301,11 +348,10 @@ void BcpLpModel::generate_vars_in_lp(const BCP_lp_result& lpres,
    int size = pModel_->getNbColumns();
    if ( size != nbCurrentColumnVarsBeforePricing_ ) { //|| ! before_fathom
       new_vars.reserve(size-nbCurrentColumnVarsBeforePricing_); //reserve the memory for the new columns
-      for(int i=nbCurrentColumnVarsBeforePricing_; i<size; ++i){
-         BcpColumn* var = dynamic_cast<BcpColumn*>(pModel_->getColumns()[i]);
-         //create a new BcpColumn which will be deleted by BCP
-         new_vars.unchecked_push_back(new BcpColumn(*var));
-      }
+      vector<BcpColumn*>& columns = pModel_->getBcpColumns();
+      for(int i=nbCurrentColumnVarsBeforePricing_; i<size; ++i)
+         //create a new BcpColumnRef which will be deleted by BCP
+         new_vars.unchecked_push_back(new BcpColumnRef(columns[i]));
       nbCurrentColumnVarsBeforePricing_ = size;
    }
 
@@ -339,6 +385,14 @@ BCP_branching_decision BcpLpModel::select_branching_candidates(const BCP_lp_resu
 	//update node
 	pModel_->updateNodeLB(lpres.objval());
 
+	//the column generation of the root is finished: store its basis to warm start the next resolve
+	if(current_index() == 0){
+		pModel_->setRootLpTime(CoinCpuTime() - rootStartTime_);
+		CoinWarmStart* ws = getLpProblemPointer()->lp_solver->getWarmStart();
+		pModel_->storeRootBasis(dynamic_cast<CoinWarmStartBasis*>(ws), vars);
+		delete ws;
+	}
+
 	//update true_lower_bound, as we reach the end of the column generation
 	getLpProblemPointer()->node->true_lower_bound = lpres.objval();
 	heuristicHasBeenRun_ = false;
@@ -359,6 +413,18 @@ BCP_branching_decision BcpLpModel::select_branching_candidates(const BCP_lp_resu
 	if(pModel_->getBestUB() - lpres.objval() < pModel_->getParameters().absoluteGap_ - EPSILON)
 		return BCP_DoNotBranch_Fathomed;
 
+	//close the tree at the root if the enumeration of the columns within the gap is small enough
+	if(current_index() == 0 && pModel_->enumerateRootColumns(lpres.objval()))
+		return BCP_DoNotBranch_Fathomed;
+
+	//the column generation is finished, so lpres.objval() is a valid bound for the subtree
+	pModel_->reducedCostFixing(lpres.objval());
+
+	//store the basis of the node to warm start its children
+	CoinWarmStart* ws = getLpProblemPointer()->lp_solver->getWarmStart();
+	pModel_->storeNodeBasis(dynamic_cast<CoinWarmStartBasis*>(ws), vars);
+	delete ws;
+
    //branching candidates: numberOfNursesByPosition_, rest on a day, ...
    vector<MyVar*> branchingCandidates;
    pModel_->branching_candidates(branchingCandidates);
@@ -468,6 +534,11 @@ void BcpLpModel::appendNewBranchingVarsOnNumberOfNurses(CoinVar* integerCoreVar,
 
       /* create the day off */
       pair<LiveNurse*, int> dayOff = pModel_->getLastBranchingRest();
+      //for a block of identical nurses, the rest child forces at least ceil(value) of them to rest
+      //and the work child at most floor(value)
+      const double multiplicity = dayOff.first->multiplicity_;
+      double restLb, workUb;
+      pModel_->getRestBranchingBounds(coreVars, restLb, workUb);
 
       //creating the branching cut
       char name[50];
@@ -480,8 +551,8 @@ void BcpLpModel::appendNewBranchingVarsOnNumberOfNurses(CoinVar* integerCoreVar,
          coeffs.push_back(1);
       }
       //create a new BcpBranchCons which will be deleted by BCP
-      BcpBranchCons* cons = new BcpBranchCons(name, pModel_->getCons().size()+pModel_->getBranchingCons().size(),
-         0, 1, indexes, coeffs);
+      BcpBranchCons* cons = new BcpBranchCons(pModel_->nameToStore(name), pModel_->getCons().size()+pModel_->getBranchingCons().size(),
+         0, multiplicity, indexes, coeffs);
       new_cuts.push_back(cons);
       //create our own new BcpBranchCons
       pModel_->pushBackBranchingCons(new BcpBranchCons(*cons));
@@ -489,14 +560,14 @@ void BcpLpModel::appendNewBranchingVarsOnNumberOfNurses(CoinVar* integerCoreVar,
       /* bounds of the cut */
       cpos.push_back(nbCuts);
       if(columns.size() > 0){
-         cbd.push_back(0); cbd.push_back(1);
+         cbd.push_back(0); cbd.push_back(multiplicity);
       }
       //push the node rest on day dayOff.second
-      cbd.push_back(1); cbd.push_back(1);
-      /* update tree */
-      pModel_->pushBackNewNode(dayOff.first, dayOff.second, true, coreVars);
+      cbd.push_back(restLb); cbd.push_back(multiplicity);
+      /* update tree: the shifts of the day are forbidden if all the nurses of the block rest */
+      pModel_->pushBackNewNode(dayOff.first, dayOff.second, restLb >= multiplicity, coreVars);
       //push the node work on day dayOff.second
-      cbd.push_back(0); cbd.push_back(0);
+      cbd.push_back(0); cbd.push_back(workUb);
       /* update tree */
       pModel_->pushBackNewNode(dayOff.first, dayOff.second, false, coreVars);
 
@@ -528,19 +599,16 @@ void BcpLpModel::appendNewBranchingVarsOnNumberOfNurses(CoinVar* integerCoreVar,
       BCP_vec<int>& vpos, BCP_vec<double>& vbd){
       //current index in the BCP formulation
       vector<int> currentIndex(columns.size());
-      for(int j=0; j<columns.size(); ++j){
-         bool found = false;
-         BcpColumn* col = dynamic_cast<BcpColumn*>(columns[j]);
-         for(int i=pModel_->getCoreVars().size(); i<vars.size(); ++i){
-            BcpColumn* col2 = dynamic_cast<BcpColumn*>(vars[i]);
-            if(col->getIndex() == col2->getIndex()){
-               currentIndex[j] = i;
-               found = true;
-               break;
-            }
+      if(columns.size() > 0){
+         //position in the formulation of each variable index (-1 if not in the formulation)
+         vector<int> positions(pModel_->getNbVars(), -1);
+         for(int i=pModel_->getCoreVars().size(); i<vars.size(); ++i)
+            positions[pModel_->getVarIndex(vars, i)] = i;
+         for(int j=0; j<columns.size(); ++j){
+            currentIndex[j] = positions[((CoinVar*) columns[j])->getIndex()];
+            if(currentIndex[j] < 0)
+               Tools::throwError("The column has not been found.");
          }
-         if(!found)
-            Tools::throwError("The column has not been found.");
       }
 
       //positions vector
@@ -577,6 +645,12 @@ const BCP_lp_result&   lpres, //solution to the current LP relaxation (IN)
 BCP_object_origin origin, //where the cuts come from (IN)
 bool  allow_multiple) //whether multiple expansion, i.e., lifting, is allowed (IN)
 {
+   //the branching cuts store the index of their variables, which can be columns (e.g. long resting arcs):
+   //position in the formulation of each variable index (-1 if not in the formulation)
+   vector<int> positions(pModel_->getNbVars(), -1);
+   for(int i=0; i<vars.size(); ++i)
+      positions[pModel_->getVarIndex(vars, i)] = i;
+
    rows.reserve(cuts.size());
    for(BCP_cut* cut: cuts){
       BcpBranchCons* branchingCut = dynamic_cast<BcpBranchCons*>(cut);
@@ -584,11 +658,16 @@ bool  allow_multiple) //whether multiple expansion, i.e., lifting, is allowed (I
          Tools::throwError("Should be a branching cut.");
 
       //create new arrays which will be deleted by ~BCP_row()
-      const int size = branchingCut->getIndexCols().size();
-      int* elementIndices = new int[size];
-      copy(branchingCut->getIndexCols().begin(), branchingCut->getIndexCols().end(), elementIndices);
-      double* elementValues = new double[size];
-      copy(branchingCut->getCoeffCols().begin(), branchingCut->getCoeffCols().end(), elementValues);
+      //the variables which are not in the formulation are skipped
+      const vector<int>& indexCols = branchingCut->getIndexCols();
+      int* elementIndices = new int[indexCols.size()];
+      double* elementValues = new double[indexCols.size()];
+      int size = 0;
+      for(int j=0; j<indexCols.size(); ++j)
+         if(positions[indexCols[j]] >= 0){
+            elementIndices[size] = positions[indexCols[j]];
+            elementValues[size++] = branchingCut->getCoeffCols()[j];
+         }
       rows.unchecked_push_back( new BCP_row(size, elementIndices, elementValues, branchingCut->getLhs(), branchingCut->getRhs()) );
    }
 }
@@ -669,13 +748,9 @@ void BcpBranchingTree::create_root(BCP_vec<BCP_var*>& added_vars,
    BCP_user_data*& user_data){
 
    added_vars.reserve(pModel_->getNbColumns());
-   for(MyVar* col: pModel_->getColumns()){
-      BcpColumn* var = dynamic_cast<BcpColumn*>(col);
-      if(!var)
-         Tools::throwError("Bad variable casting.");
-      //create a new BcpColumn which will be deleted by BCP
-      added_vars.unchecked_push_back(new BcpColumn(*var));
-   }
+   for(BcpColumn* col: pModel_->getBcpColumns())
+      //create a new BcpColumnRef which will be deleted by BCP
+      added_vars.unchecked_push_back(new BcpColumnRef(col));
 }
 
 void BcpBranchingTree::display_feasible_solution(const BCP_solution* sol){
@@ -712,7 +787,8 @@ void BcpBranchingTree::init_new_phase(int phase, BCP_column_generation& colgen,
 BcpModeler::BcpModeler(const char* name):
    CoinModeler(), currentNode_(0), tree_size_(1), nb_nodes_last_incumbent_(0), diveDepth_(0), diveLenght_(LARGE_SCORE),
    primalValues_(0), dualValues_(0), reducedCosts_(0), lhsValues_(0),
-   best_lb_in_root(LARGE_SCORE), best_lb(LARGE_SCORE), lastNbSubProblemsSolved_(0), lastMinDualCost_(0)
+   best_lb_in_root(LARGE_SCORE), best_lb(LARGE_SCORE), lastNbSubProblemsSolved_(0), lastMinDualCost_(0),
+   rootLpIterations_(0), rootLpTime_(0), solveStartTime_(0), pMipHeuristic_(0)
 {
    //create the root
    pushBackNewNode();
@@ -722,7 +798,22 @@ BcpModeler::BcpModeler(const char* name):
 int BcpModeler::solve(bool relaxatione){
    BcpInitialize bcp(this);
    char** argv;
-   int value = bcp_main(0, argv, &bcp);
+   solveStartTime_ = CoinWallclockTime();
+
+#ifdef USE_CBC
+   if(parameters_.mipHeuristicTime_ > 0 && parameters_.stopAfterXSolution_ != 0)
+      pMipHeuristic_ = new RestrictedMasterHeuristic(parameters_.mipHeuristicTime_);
+#endif
+
+   int value;
+   try{
+      value = bcp_main(0, argv, &bcp);
+   }
+   catch(...){
+      stopMipHeuristic();
+      throw;
+   }
+   stopMipHeuristic();
 
    /* clear tree */
    for(BcpNode* node: tree_)
@@ -748,7 +839,10 @@ void BcpModeler::reset() {
    best_lb = LARGE_SCORE;
    lastNbSubProblemsSolved_=0;
    lastMinDualCost_=0;
+   rootLpIterations_=0;
+   rootLpTime_=0;
    solHasChanged_ = false;
+   //rootBasis_ is kept to warm start the next solve
 
    obj_history_.clear();
    primalValues_.clear();
@@ -768,14 +862,18 @@ void BcpModeler::reset() {
  *    vartype is the type of the variable: SCIP_VARTYPE_CONTINUOUS, SCIP_VARTYPE_INTEGER, SCIP_VARTYPE_BINARY
  */
 int BcpModeler::createCoinVar(CoinVar** var, const char* var_name, int index, double objCoeff, VarType vartype, double lb, double ub){
-   *var = new BcpCoreVar(var_name, index, objCoeff, vartype, lb, ub);
-   objects_.push_back(*var);
+   BcpCoreVar* var2 = new BcpCoreVar(var_name, index, objCoeff, vartype, lb, ub);
+   bcpCoreVars_.push_back(var2);
+   objects_.push_back(var2);
+   *var = var2;
    return 1;
 }
 
 int BcpModeler::createColumnCoinVar(CoinVar** var, const char* var_name, int index, double objCoeff, double dualObj, VarType vartype, double lb, double ub){
-   *var = new BcpColumn(var_name, index, objCoeff, dualObj, vartype, lb, ub);
-   objects_.push_back(*var);
+   BcpColumn* var2 = new BcpColumn(var_name, index, objCoeff, dualObj, vartype, lb, ub);
+   bcpColumns_.push_back(var2);
+   objects_.push_back(var2);
+   *var = var2;
    return 1;
 }
 
@@ -827,15 +925,103 @@ void BcpModeler::setLPSol(const BCP_lp_result& lpres, const BCP_vec<BCP_var*>&
    reducedCosts_.insert(reducedCosts_.end(), zeroArray, zeroArray+nbColVar);
    //loop through the variables and link the good columns together
    for(int i=nbCoreVar; i<vars.size(); ++i){
-      BCP_var* var0 = vars[i];
-      BcpColumn* var = dynamic_cast<BcpColumn*>(var0);
-      primalValues_[var->getIndex()] = lpres.x()[i];
-      reducedCosts_[var->getIndex()] = lpres.dj()[i];
+      const int index = getVarIndex(vars, i);
+      primalValues_[index] = lpres.x()[i];
+      reducedCosts_[index] = lpres.dj()[i];
    }
 
    if (zeroArray) free(zeroArray);
 }
 
+/*
+ * Warm start
+ */
+
+void BcpModeler::storeBasis(const CoinWarmStartBasis* basis, const BCP_vec<BCP_var*>& vars, BcpBasis& stored){
+   if(!basis)
+      return;
+
+   stored.basis_ = *basis;
+   stored.varIndexes_.resize(vars.size());
+   for(int i=0; i<vars.size(); ++i)
+      stored.varIndexes_[i] = getVarIndex(vars, i);
+}
+
+CoinWarmStartBasis* BcpModeler::buildBasis(BcpBasis& stored, const BCP_vec<BCP_var*>& vars, const BCP_vec<BCP_cut*>& cuts){
+   if(stored.empty())
+      return 0;
+
+   //position in the stored basis of each variable (-1 if it was not in the formulation)
+   vector<int> positions(getNbVars(), -1);
+   for(int i=0; i<stored.varIndexes_.size(); ++i)
+      positions[stored.varIndexes_[i]] = i;
+
+   const int nbStoredCons = stored.basis_.getNumArtificial();
+   CoinWarmStartBasis* basis = new CoinWarmStartBasis();
+   basis->setSize(vars.size(), cuts.size());
+   //the columns which were not in the formulation are at their lower bound
+   for(int i=0; i<vars.size(); ++i){
+      const int position = positions[getVarIndex(vars, i)];
+      if(position >= 0)
+         basis->setStructStatus(i, stored.basis_.getStructStatus(position));
+      else
+         basis->setStructStatus(i, CoinWarmStartBasis::atLowerBound);
+   }
+   //the core constraints are always the first rows of the formulation, then the branching constraints
+   //in their order of creation: the rows which were not in the formulation are basic
+   for(int i=0; i<cuts.size(); ++i){
+      if(i < nbStoredCons)
+         basis->setArtifStatus(i, stored.basis_.getArtifStatus(i));
+      else
+         basis->setArtifStatus(i, CoinWarmStartBasis::basic);
+   }
+
+   return basis;
+}
+
+/*
+ * Reduced cost fixing
+ */
+
+void BcpModeler::reducedCostFixing(double lb){
+   //no incumbent
+   if(!currentNode_ || best_ub >= LARGE_SCORE - EPSILON)
+      return;
+
+   //a solution must be at least absoluteGap_ better than best_ub to improve it,
+   //and its cost is at least lb + the reduced cost of any variable set to 1
+   const double gap = best_ub - parameters_.absoluteGap_ - lb;
+   vector<int>& fixedVars = currentNode_->fixedVars_;
+   for(CoinVar* col: columnVars_){
+      const int index = col->getIndex();
+      //the columns generated after the last LP solution are not in the formulation
+      if(index >= reducedCosts_.size())
+         break;
+      if(primalValues_[index] < EPSILON && reducedCosts_[index] > gap + EPSILON)
+         fixedVars.push_back(index);
+   }
+   for(MyVar* var: fixableCoreVars_){
+      const int index = ((CoinVar*) var)->getIndex();
+      if(primalValues_[index] < EPSILON && reducedCosts_[index] > gap + EPSILON)
+         fixedVars.push_back(index);
+   }
+}
+
+bool BcpModeler::getFixedVars(vector<bool>& fixedVars){
+   bool found = false;
+   for(BcpNode* node = currentNode_; node; node = node->pParent_){
+      if(node->fixedVars_.size() == 0)
+         continue;
+      if(!found){
+         fixedVars.assign(getNbVars(), false);
+         found = true;
+      }
+      for(int index: node->fixedVars_)
+         fixedVars[index] = true;
+   }
+   return found;
+}
+
 void BcpModeler::addBcpSol(const BCP_solution* sol){
    //if no integer solution is needed, don't store the solutions
    if(parameters_.stopAfterXSolution_ == 0)
@@ -845,15 +1031,14 @@ void BcpModeler::addBcpSol(const BCP_solution* sol){
    BCP_solution_generic mySol(false);
    BCP_solution_generic* sol2 = (BCP_solution_generic*) sol;
 
-   int coreSize = coreVars_.size();
    for(int i=0; i<sol2->_vars.size(); ++i){
-      BcpColumn* col = dynamic_cast<BcpColumn*>(sol2->_vars[i]);
-      if(col){
-         BcpColumn* myCol = (BcpColumn*) columnVars_[col->getIndex()-coreSize];
+      BCP_var* var = sol2->_vars[i];
+      if(var->obj_type() == BCP_AlgoObj){
+         BcpColumn* myCol = getBcpColumn(static_cast<BcpColumnRef*>(var)->getIndex());
          mySol.add_entry(myCol, sol2->_values[i]);
       }
       else{
-         BcpCoreVar* myVar = (BcpCoreVar*) coreVars_[sol2->_vars[i]->bcpind()];
+         BcpCoreVar* myVar = bcpCoreVars_[var->bcpind()];
          mySol.add_entry(myVar, sol2->_values[i]);
       }
    }
@@ -986,6 +1171,10 @@ bool BcpModeler::doStop(){
    if(getBestLB() >= LARGE_SCORE)
       return false;
 
+   //check the cut-off
+   if(getBestLB() > parameters_.cutOff_ + EPSILON)
+      throw FeasibleStop("Stopped: the lower bound exceeds the cut-off.");
+
    //check the number of solution
    if(nbSolutions() >= parameters_.stopAfterXSolution_){
       char error[100];
@@ -1023,6 +1212,169 @@ bool BcpModeler::doStop(){
    return false;
 }
 
+BCP_solution_generic* BcpModeler::runMipHeuristic(){
+   BCP_solution_generic* sol = 0;
+   if(!pMipHeuristic_)
+      return sol;
+
+#ifdef USE_CBC
+   //create a BCP_solution_generic with the last solution of the heuristic:
+   //BCP will give it to display_feasible_solution as any other heuristic solution
+   vector<double> values;
+   if(pMipHeuristic_->getNewSolution(values))
+      sol = createBcpSol(values);
+
+   //a solution has to be at least absoluteGap_ better than best_ub to be useful
+   pMipHeuristic_->start(this, best_ub - parameters_.absoluteGap_ + EPSILON);
+#endif
+
+   return sol;
+}
+
+BCP_solution_generic* BcpModeler::createBcpSol(vector<double>& values){
+   const int coreSize = bcpCoreVars_.size();
+   BCP_solution_generic* sol = new BCP_solution_generic();
+   for(int i=0; i<values.size(); ++i)
+      if(values[i] > EPSILON){
+         //create new var that will be deleted by the solution sol
+         if(i<coreSize)
+            sol->add_entry(new BcpCoreVar(*getBcpCoreVar(i)), values[i]);
+         else
+            sol->add_entry(new BcpColumnRef(getBcpColumn(i)), values[i]);
+      }
+   return sol;
+}
+
+bool BcpModeler::enumerateRootColumns(double lb){
+#ifdef USE_CBC
+   const double gap = best_ub - parameters_.absoluteGap_ - lb;
+   if(!pPricer_ || gap > parameters_.enumerationGap_)
+      return false;
+
+   //too many columns: go on with the branch-and-price
+   if(!pPricer_->enumerate(gap, parameters_.enumerationMaxColumns_))
+      return false;
+
+   //solve the restricted master with all the remaining time: as in runMipHeuristic,
+   //a solution has to be at least absoluteGap_ better than best_ub to be useful
+   const double timeLeft = parameters_.maxSolvingTimeSeconds_ - (CoinWallclockTime() - solveStartTime_);
+   if(timeLeft <= 0)
+      return false;
+   RestrictedMasterHeuristic mip(timeLeft);
+   mip.start(this, best_ub - parameters_.absoluteGap_ + EPSILON);
+   mip.wait();
+
+   vector<double> values;
+   if(mip.getNewSolution(values)){
+      BCP_solution_generic* sol = createBcpSol(values);
+      addBcpSol(sol);
+      delete sol;
+   }
+
+   return mip.isSearchComplete();
+#else
+   return false;
+#endif
+}
+
+void BcpModeler::stopMipHeuristic(){
+#ifdef USE_CBC
+   delete pMipHeuristic_;
+#endif
+   pMipHeuristic_ = 0;
+}
+
+/*
+ * RestrictedMasterHeuristic
+ */
+#ifdef USE_CBC
+RestrictedMasterHeuristic::~RestrictedMasterHeuristic(){
+   {
+      lock_guard<mutex> lock(mutex_);
+      stop_ = true;
+      if(pCbcModel_)
+         pCbcModel_->sayEventHappened();
+   }
+   if(thread_.joinable())
+      thread_.join();
+}
+
+void RestrictedMasterHeuristic::start(CoinModeler* pModel, double cutoff){
+   {
+      lock_guard<mutex> lock(mutex_);
+      if(running_ || pModel->getNbVars() == nbVarsLastRun_)
+         return;
+      running_ = true;
+   }
+   //the previous run is over
+   if(thread_.joinable())
+      thread_.join();
+   nbVarsLastRun_ = pModel->getNbVars();
+
+   //copy the restricted master: the thread never accesses the model
+   OsiClpSolverInterface* pSolver = new OsiClpSolverInterface();
+   pSolver->messageHandler()->setLogLevel(0);
+   pModel->loadProblem(*pSolver);
+   int index = 0;
+   for(MyVar* var: pModel->getCoreVars()){
+      if(var->getVarType() != VARTYPE_CONTINUOUS)
+         pSolver->setInteger(index);
+      ++index;
+   }
+   for(; index<nbVarsLastRun_; ++index)
+      pSolver->setInteger(index);
+
+   thread_ = thread(&RestrictedMasterHeuristic::run, this, pSolver, cutoff);
+}
+
+void RestrictedMasterHeuristic::run(OsiClpSolverInterface* pSolver, double cutoff){
+   CbcModel model(*pSolver);
+   delete pSolver;
+   model.setLogLevel(0);
+   model.setMaximumSeconds(timeLimit_);
+   model.setCutoff(cutoff);
+
+   {
+      lock_guard<mutex> lock(mutex_);
+      if(stop_){
+         running_ = false;
+         return;
+      }
+      pCbcModel_ = &model;
+   }
+
+   model.branchAndBound();
+
+   lock_guard<mutex> lock(mutex_);
+   pCbcModel_ = 0;
+   running_ = false;
+   searchComplete_ = !stop_ && (model.isProvenOptimal() || model.isProvenInfeasible());
+   if(model.bestSolution() && !stop_){
+      solution_.assign(model.bestSolution(), model.bestSolution()+model.getNumCols());
+      hasNewSolution_ = true;
+   }
+}
+
+bool RestrictedMasterHeuristic::getNewSolution(vector<double>& values){
+   lock_guard<mutex> lock(mutex_);
+   if(!hasNewSolution_)
+      return false;
+   values = solution_;
+   hasNewSolution_ = false;
+   return true;
+}
+
+void RestrictedMasterHeuristic::wait(){
+   if(thread_.joinable())
+      thread_.join();
+}
+
+bool RestrictedMasterHeuristic::isSearchComplete(){
+   lock_guard<mutex> lock(mutex_);
+   return searchComplete_;
+}
+#endif
+
 /**************
  * Outputs *
  *************/
@@ -22,6 +22,10 @@
 #include "BCP_solution.hpp"
 #include "OsiClpSolverInterface.hpp"
 #include "CoinSearchTree.hpp"
+#include "CoinWarmStartBasis.hpp"
+
+#include <thread>
+#include <mutex>
 
 /*
  * My Variables
@@ -79,6 +83,24 @@ struct BcpColumn: public CoinVar, public BCP_var_algo{
    ~BcpColumn(){ }
 };
 
+//light handle on a BcpColumn given to BCP, which deletes it when the column leaves the formulation.
+//The column itself stays in the typed table of the BcpModeler and is found back through index_.
+struct BcpColumnRef: public BCP_var_algo{
+   BcpColumnRef(BcpColumn* col):
+      BCP_var_algo(BcpCoreVar::getBcpVarType(col->getVarType()), col->getCost(), col->getLB(), col->getUB()),
+      index_(col->getIndex())
+   {
+      set_bcpind(index_);
+   }
+
+   ~BcpColumnRef(){ }
+
+   int getIndex() const { return index_; }
+
+protected:
+   const int index_; //index of the column in the BcpModeler
+};
+
 /*
  * My Constraints
  */
@@ -120,6 +142,15 @@ vector<int> indexCols_; //index of the cols of the matrix where the col has non-
 vector<double> coeffs_; //value of these coefficients
 };
 
+//basis of a formulation stored with the index of the variable of each of its columns,
+//so that it can be loaded in a formulation with other columns or in another order
+struct BcpBasis{
+   CoinWarmStartBasis basis_;
+   vector<int> varIndexes_;
+
+   inline bool empty() { return varIndexes_.empty(); }
+};
+
 struct BcpNode{
 
    BcpNode(): index_(0), bestLB_(LARGE_SCORE), pParent_(0), highestGap_(0), pNurse_(0), day_(0), rest_(false), pNumberOfNurses_(0), nursesLhs_(-LARGE_SCORE), nursesRhs_(LARGE_SCORE) {}
@@ -179,6 +210,12 @@ struct BcpNode{
    const CoinVar* pNumberOfNurses_;
    const double nursesLhs_, nursesRhs_;
 
+   //indices of the variables fixed to 0 by reduced cost at the end of this node: valid for all its subtree
+   vector<int> fixedVars_;
+
+   //basis at the end of the column generation of this node: warm start of its children
+   BcpBasis warmStart_;
+
 protected:
    double bestLB_;
    //highest gap between the bestLB_ and the computed bestLB_ of the children
@@ -188,6 +225,52 @@ protected:
    vector<BcpNode*> children_;
 };
 
+/*
+ * Restricted master heuristic:
+ * solve as a MIP with Cbc the master problem restricted to all the columns generated so far.
+ * Each run works on its own copy of the problem in a background thread with a time limit,
+ * and the solutions found are given to BCP by BcpLpModel::generate_heuristic_solution.
+ * Cbc is only linked when USE_CBC is defined: otherwise the heuristic is never created.
+ */
+class CbcModel;
+
+class RestrictedMasterHeuristic{
+public:
+   RestrictedMasterHeuristic(double timeLimit):
+      timeLimit_(timeLimit), pCbcModel_(0), running_(false), stop_(false), hasNewSolution_(false), searchComplete_(false),
+      nbVarsLastRun_(0)
+   { }
+
+   //interrupt the current run and wait for its thread
+   ~RestrictedMasterHeuristic();
+
+   //launch a new run on the current columns of the model if the previous one is over and
+   //if some columns have been generated since then; only the solutions under cutoff are kept
+   void start(CoinModeler* pModel, double cutoff);
+
+   //return true if a solution has been found since the last call: values are indexed by the index of the variables
+   bool getNewSolution(vector<double>& values);
+
+   //wait for the end of the current run
+   void wait();
+
+   //return true if the last run has proven that there is no solution under its cutoff other than the one found
+   bool isSearchComplete();
+
+protected:
+   //solve the MIP and delete the solver
+   void run(OsiClpSolverInterface* pSolver, double cutoff);
+
+   const double timeLimit_;
+   thread thread_;
+   //protect all the following members, which are shared with the thread
+   mutex mutex_;
+   CbcModel* pCbcModel_;
+   bool running_, stop_, hasNewSolution_, searchComplete_;
+   int nbVarsLastRun_;
+   vector<double> solution_;
+};
+
 class BcpModeler: public CoinModeler {
 public:
    BcpModeler(const char* name);
@@ -281,6 +364,60 @@ public:
 
    inline double getLastObj(){ return obj_history_[obj_history_.size()-1]; }
 
+   /*
+    * Warm start: the bases are stored by index of the variables and by position of the rows,
+    * so that they can be loaded whatever the columns of the LP and their order
+    */
+   void storeBasis(const CoinWarmStartBasis* basis, const BCP_vec<BCP_var*>& vars, BcpBasis& stored);
+
+   //return 0 if no basis has been stored, otherwise return a basis for the given formulation
+   CoinWarmStartBasis* buildBasis(BcpBasis& stored, const BCP_vec<BCP_var*>& vars, const BCP_vec<BCP_cut*>& cuts);
+
+   //warm start of a resolve with the basis of the last root node
+   inline void storeRootBasis(const CoinWarmStartBasis* basis, const BCP_vec<BCP_var*>& vars){
+      storeBasis(basis, vars, rootBasis_);
+   }
+
+   inline CoinWarmStartBasis* buildRootBasis(const BCP_vec<BCP_var*>& vars, const BCP_vec<BCP_cut*>& cuts){
+      return buildBasis(rootBasis_, vars, cuts);
+   }
+
+   inline bool hasRootBasis(){ return !rootBasis_.empty(); }
+
+   //warm start of the children of the current node with its final basis
+   inline void storeNodeBasis(const CoinWarmStartBasis* basis, const BCP_vec<BCP_var*>& vars){
+      storeBasis(basis, vars, currentNode_->warmStart_);
+   }
+
+   inline CoinWarmStartBasis* buildParentBasis(const BCP_vec<BCP_var*>& vars, const BCP_vec<BCP_cut*>& cuts){
+      if(!currentNode_->pParent_)
+         return 0;
+      return buildBasis(currentNode_->pParent_->warmStart_, vars, cuts);
+   }
+
+   inline void addRootLpIterations(int nbIterations){ rootLpIterations_ += nbIterations; }
+
+   inline int getRootLpIterations(){ return rootLpIterations_; }
+
+   inline void setRootLpTime(double time){ rootLpTime_ = time; }
+
+   inline double getRootLpTime(){ return rootLpTime_; }
+
+   /*
+    * Typed access to the variables: avoid to cast each BCP_var of a formulation
+    */
+   inline BcpCoreVar* getBcpCoreVar(int index){ return bcpCoreVars_[index]; }
+
+   inline BcpColumn* getBcpColumn(int index){ return bcpColumns_[index - bcpCoreVars_.size()]; }
+
+   inline vector<BcpColumn*>& getBcpColumns(){ return bcpColumns_; }
+
+   //index of the variable at the position i of a BCP formulation:
+   //the core variables are always the first ones and all the others are BcpColumnRef
+   inline int getVarIndex(const BCP_vec<BCP_var*>& vars, int i){
+      return (i < bcpCoreVars_.size()) ? i : static_cast<const BcpColumnRef*>(vars[i])->getIndex();
+   }
+
    /*
     * Manage the storage of our own tree
     */
@@ -316,6 +453,17 @@ public:
          currentNode_->pushBackChild(node);
    }
 
+   /*
+    * Reduced cost fixing: once an incumbent exists, the columns and the fixable core variables
+    * at 0 whose reduced cost is greater than the gap between the best upper bound and
+    * lb (the lower bound of the current node) are fixed to 0 for all the subtree of the current node
+    */
+   void reducedCostFixing(double lb);
+
+   //fill fixedVars with the variables fixed by reduced cost at the ancestors of the current node
+   //return false if there is none
+   bool getFixedVars(vector<bool>& fixedVars);
+
    inline  void addForbidenShifts(LiveNurse* pNurse, set<pair<int,int> >& forbidenShifts) {
       BcpNode* node = currentNode_;
       vector<MyVar*> arcs;
@@ -334,6 +482,12 @@ public:
 //         cout << arcs[i]->name_ << " " << getVarValue(arcs[i]) << endl;
    }
 
+   inline void getBranchedDays(LiveNurse* pNurse, set<int>& days) {
+      for(BcpNode* node = currentNode_; node && node->pParent_; node = node->pParent_)
+         if(node->pNurse_ == pNurse)
+            days.insert(node->day_);
+   }
+
    inline void setCurrentNode(const CoinTreeSiblings* s) {
       /* the current node of this siblings is already taken as processed */
       int nodeIndex = s->size() - s->toProcess() - 1;
@@ -364,6 +518,8 @@ public:
       diveDepth_ = s->currentNode()->getDepth();
    }
 
+   inline BcpNode* getCurrentNode() { return currentNode_; }
+
    inline BcpNode* getNode(const CoinTreeSiblings* s) {
       int nodeIndex = s->size() - s->toProcess();
       return treeMapping_[s][nodeIndex];
@@ -413,6 +569,17 @@ public:
    //check if Bcp stops
    bool doStop();
 
+   //restricted master heuristic: return its last solution (0 if none) and launch a new run if the previous one is over
+   BCP_solution_generic* runMipHeuristic();
+
+   /*
+    * Root enumeration: once the column generation of the root is over, if the gap between the best upper bound
+    * and lb is smaller than enumerationGap_, all the columns whose reduced cost is smaller than this gap are
+    * generated and the restricted master is solved as a MIP with the remaining time.
+    * Return true if the MIP is solved to optimality: the tree can then be closed.
+    */
+   bool enumerateRootColumns(double lb);
+
 protected:
    //branching tree
    vector<BcpNode*> tree_;
@@ -429,16 +596,36 @@ protected:
    vector<double> obj_history_;
    vector<double> primalValues_, dualValues_, reducedCosts_, lhsValues_;
    bool solHasChanged_ = false; //reload solution ?
+   //typed copies of coreVars_ and columnVars_
+   vector<BcpCoreVar*> bcpCoreVars_;
+   vector<BcpColumn*> bcpColumns_;
    //bcp branching cons
    vector<BcpBranchCons*> branchingCons_;
    //bcp solution
    vector<BCP_solution_generic> bcpSolutions_;
+   //restricted master heuristic (0 if not used)
+   RestrictedMasterHeuristic* pMipHeuristic_;
+
+   //interrupt and delete the restricted master heuristic
+   void stopMipHeuristic();
+
+   //create a solution with the values of the variables indexed by their index: the solution owns its vars
+   BCP_solution_generic* createBcpSol(vector<double>& values);
 
    /* stats */
    //number of sub problems solved on the last iteration of column generation
    int lastNbSubProblemsSolved_;
    //min dual cost for a rotation on the last iteration of column generation
    double lastMinDualCost_;
+   //number of simplex iterations and time spent to solve the root node
+   int rootLpIterations_;
+   double rootLpTime_;
+   //wall clock time at the start of the solve
+   double solveStartTime_;
+
+   /* warm start */
+   //basis of the last root node solved
+   BcpBasis rootBasis_;
 
    /* Parameters */
    //At every this many search tree node provide a single line info on the progress of the search tree.
@@ -652,6 +839,12 @@ protected:
    int last_node;
    //if heuristic has been run. To be sure to run the heuristic no more than one time per node
    bool heuristicHasBeenRun_;
+   //if the stored basis has already been loaded for the root node
+   bool rootBasisLoaded_;
+   //last node processed: a node processed right after its parent (dive) already has the basis of its parent
+   BcpNode* pLastNode_;
+   //cpu time when the root node has been started
+   double rootStartTime_;
 
    //vars = are just the giver vars
    //cols is the vector where the new columns will be stored
@@ -829,16 +1022,15 @@ public:
    BcpPacker(BcpModeler* pModel): pModel_(pModel){}
    ~BcpPacker() {}
 
-   void pack_var_algo(const BCP_var_algo* var, BCP_buffer& buf) { buf.pack(((BcpColumn*)var)->getIndex()); }
+   void pack_var_algo(const BCP_var_algo* var, BCP_buffer& buf) { buf.pack(((BcpColumnRef*)var)->getIndex()); }
 
    BCP_var_algo* unpack_var_algo(BCP_buffer& buf) {
       int index = 0;
       buf.unpack(index);
-      int i = index - pModel_->getCoreVars().size();
-      BcpColumn* var = (BcpColumn*) pModel_->getColumns()[i];
+      BcpColumn* var = pModel_->getBcpColumn(index);
       if(index != var->getIndex())
          Tools::throwError("Bad column unpacked or packed.");
-      return new BcpColumn(*var);
+      return new BcpColumnRef(var);
    }
 
    void pack_cut_algo(const BCP_cut_algo* cons, BCP_buffer& buf) { buf.pack(((BcpBranchCons*)cons)->getIndex()); }
@@ -299,14 +299,14 @@ int CbcModeler::printBestSol(){
   for(CoinVar* var: coreVars_){
     double value = getVarValue(var);
      if( fabs(value)>tolerance)
-        fprintf(pFile, "%-30s %4.2f (%6.0f) \n", var->name_ , value, var->getCost());
+        fprintf(pFile, "%-30s %4.2f (%6.0f) \n", var->getName().c_str() , value, var->getCost());
   }
 
   //iterate on column variables
   for(CoinVar* var: columnVars_){
     double value = getVarValue(var);
      if( fabs(value)>tolerance)
-        fprintf(pFile, "%-30s %4.2f (%6.0f) \n", var->name_ , value, var->getCost());
+        fprintf(pFile, "%-30s %4.2f (%6.0f) \n", var->getName().c_str() , value, var->getCost());
   }
 
   fprintf(pFile, "\n");
@@ -0,0 +1,843 @@
+/*
+ * ClpModeler.cpp
+ *
+ */
+
+#include "ClpModeler.h"
+
+//worker processing nodes in the current thread (0 out of the workers)
+static thread_local ClpWorker* pCurrentWorker = 0;
+
+/*
+ * ClpWorker
+ */
+
+ClpWorker::ClpWorker(ClpModeler* pModel, MyPricer* pPricer, MyBranchingRule* pRule, bool ownsHandlers):
+   pModel_(pModel), pPricer_(pPricer), pRule_(pRule), ownsHandlers_(ownsHandlers), nbVarsInLP_(0),
+   pNode_(0), nbColumnsGenerated_(0), lastBranchingRest_(0, -1)
+{
+   solver_.messageHandler()->setLogLevel(0);
+}
+
+ClpWorker::~ClpWorker(){
+   if(ownsHandlers_){
+      delete pPricer_;
+      delete pRule_;
+   }
+   for(MyPricer* pPricer: evaluationPricers_)
+      delete pPricer;
+}
+
+/*
+ * ClpModeler
+ */
+
+ClpModeler::ClpModeler(const char* name):
+   CoinModeler(), nbActiveWorkers_(0), nbNodesCreated_(0), nbNodes_(0), nbNodesLastIncumbent_(0), diveLength_(LARGE_SCORE),
+   stop_(false), best_lb_in_root(LARGE_SCORE), solveStartTime_(0)
+{ }
+
+//solve the model
+int ClpModeler::solve(bool relaxation){
+   solveStartTime_ = CoinWallclockTime();
+
+   //number of workers: 0 means one per core
+   int nbThreads = parameters_.nbThreads_;
+   if(nbThreads <= 0)
+      nbThreads = max(1, (int) thread::hardware_concurrency());
+
+   //each worker gets its own copy of the LP
+   for(int t=0; t<nbThreads; ++t){
+      MyPricer* pPricer = pPricer_;
+      MyBranchingRule* pRule = pBranchingRule_;
+      if(t > 0){
+         pPricer = pPricer_ ? pPricer_->clone() : 0;
+         pRule = pBranchingRule_ ? pBranchingRule_->clone() : 0;
+         if((pPricer_ && !pPricer) || (pBranchingRule_ && !pRule))
+            Tools::throwError("The pricer and the branching rule must be cloned to solve with several threads.");
+      }
+      ClpWorker* pWorker = new ClpWorker(this, pPricer, pRule, t > 0);
+      loadProblem(pWorker->solver_);
+      pWorker->nbVarsInLP_ = getNbVars();
+      workers_.push_back(pWorker);
+   }
+
+   //create the root and process the tree
+   stop_ = false;
+   stopException_ = nullptr;
+   nbActiveWorkers_ = 0;
+   nbNodesCreated_ = 1;
+   nodes_.push_back(new ClpNode());
+
+   vector<thread> threads;
+   for(int t=1; t<nbThreads; ++t)
+      threads.push_back(thread(&ClpModeler::runWorker, this, workers_[t]));
+   runWorker(workers_[0]);
+   for(thread& th: threads)
+      th.join();
+
+   /* clear tree */
+   for(ClpNode* pNode: nodes_)
+      delete pNode;
+   nodes_.clear();
+   for(ClpWorker* pWorker: workers_)
+      delete pWorker;
+   workers_.clear();
+
+   //forward the exception which has stopped the search
+   if(stopException_){
+      exception_ptr e = stopException_;
+      stopException_ = nullptr;
+      rethrow_exception(e);
+   }
+
+   return 1;
+}
+
+//reinitialize all parameters and clear vectors
+void ClpModeler::reset(){
+   best_ub = LARGE_SCORE;
+   nbNodesCreated_ = 0;
+   nbNodes_ = 0;
+   nbNodesLastIncumbent_ = 0;
+   diveLength_ = LARGE_SCORE;
+   best_lb_in_root = LARGE_SCORE;
+   solutions_.clear();
+   primalValues_.clear();
+}
+
+/*
+ * Create core variable:
+ *    var is a pointer to the pointer of the variable
+ *    var_name is the name of the variable
+ *    lb, ub are the lower and upper bound of the variable
+ *    vartype is the type of the variable: VARTYPE_CONTINUOUS, VARTYPE_INTEGER, VARTYPE_BINARY
+ */
+int ClpModeler::createCoinVar(CoinVar** var, const char* var_name, int index, double objCoeff, VarType vartype, double lb, double ub){
+   *var = new CoinVar(var_name, index, objCoeff, vartype, lb, ub);
+   objects_.push_back(*var);
+   return 1;
+}
+
+int ClpModeler::createColumnCoinVar(CoinVar** var, const char* var_name, int index, double objCoeff, double dualObj, VarType vartype, double lb, double ub){
+   *var = new CoinVar(var_name, index, objCoeff, vartype, lb, ub, dualObj);
+   objects_.push_back(*var);
+   //the worker knows that its pricing has found some columns
+   if(pCurrentWorker)
+      ++pCurrentWorker->nbColumnsGenerated_;
+   return 1;
+}
+
+/*
+ * Create linear constraint:
+ *    con is a pointer to the pointer of the constraint
+ *    con_name is the name of the constraint
+ *    lhs, rhs are the lower and upper bound of the constraint
+ */
+int ClpModeler::createCoinConsLinear(CoinCons** con, const char* con_name, int index, double lhs, double rhs){
+   *con = new CoinCons(con_name, index, lhs, rhs);
+   objects_.push_back(*con);
+   return 1;
+}
+
+/*
+ * Get the primal values and the dual variables
+ */
+
+double ClpModeler::getVarValue(MyVar* var){
+   ClpWorker* pWorker = pCurrentWorker;
+   vector<double>& values = (pWorker && pWorker->pModel_ == this) ? pWorker->primalValues_ : primalValues_;
+   if(values.size() == 0)
+      Tools::throwError("Primal solution has been initialized.");
+   //the columns generated after the last LP solution are not in the solution
+   const int index = ((CoinVar*) var)->getIndex();
+   return (index < values.size()) ? values[index] : 0;
+}
+
+double ClpModeler::getDual(MyCons* cons, bool transformed){
+   ClpWorker* pWorker = pCurrentWorker;
+   if(!pWorker || pWorker->pModel_ != this || pWorker->dualValues_.size() == 0)
+      Tools::throwError("Dual solution has been initialized.");
+   return pWorker->dualValues_[((CoinCons*) cons)->getIndex()];
+}
+
+void ClpModeler::setBestUB(double ub){
+   /* reinitialize nbNodesLastIncumbent_ */
+   if(ub + 1 < best_ub) nbNodesLastIncumbent_ = 0;
+   if(ub < best_ub) best_ub = ub;
+}
+
+/*
+ * Branching decisions of the node processed by the worker of the thread
+ */
+
+void ClpModeler::addForbidenShifts(LiveNurse* pNurse, set<pair<int,int> >& forbidenShifts){
+   ClpWorker* pWorker = pCurrentWorker;
+   if(!pWorker || !pWorker->pNode_)
+      return;
+   for(pair<LiveNurse*, int>& p: pWorker->pNode_->restDays_)
+      if(p.first == pNurse)
+         for(int i=1; i<pNurse->pScenario_->nbShifts_; ++i)
+            forbidenShifts.insert(pair<int,int>(p.second, i));
+}
+
+void ClpModeler::getBranchedDays(LiveNurse* pNurse, set<int>& days){
+   ClpWorker* pWorker = pCurrentWorker;
+   if(!pWorker || !pWorker->pNode_)
+      return;
+   for(pair<LiveNurse*, int>& p: pWorker->pNode_->restDays_)
+      if(p.first == pNurse)
+         days.insert(p.second);
+   for(pair<LiveNurse*, int>& p: pWorker->pNode_->boundedDays_)
+      if(p.first == pNurse)
+         days.insert(p.second);
+}
+
+bool ClpModeler::evaluateRestBranching(vector<pair<LiveNurse*, int> >& restDays, vector<vector<MyVar*> >& restVars,
+   vector<pair<double,double> >& gains){
+   ClpWorker* pWorker = pCurrentWorker;
+   if(!pWorker || !pWorker->pNode_ || !pWorker->pPricer_)
+      return false;
+
+   //each child needs its own pricer
+   const int nbChildren = 2*restDays.size();
+   while(pWorker->evaluationPricers_.size() < nbChildren){
+      MyPricer* pPricer = pWorker->pPricer_->clone();
+      if(!pPricer)
+         return false;
+      pWorker->evaluationPricers_.push_back(pPricer);
+   }
+
+   //the children start from a copy of the LP of the worker: rest then work for each candidate
+   vector<ClpWorker*> children;
+   for(int c=0; c<restDays.size(); ++c){
+      vector<int> indexCols;
+      for(MyVar* var: restVars[c])
+         indexCols.push_back(((CoinVar*) var)->getIndex());
+      vector<double> coeffs(indexCols.size(), 1);
+      CoinPackedVector vector(indexCols.size(), indexCols.data(), coeffs.data());
+
+      //bounds of the rest child, then of the work child
+      const double multiplicity = restDays[c].first->multiplicity_;
+      double restLb, workUb;
+      getRestBranchingBounds(restVars[c], restLb, workUb);
+      const double lhs[2] = {restLb, 0}, rhs[2] = {multiplicity, workUb};
+
+      for(int j=0; j<2; ++j){
+         ClpWorker* pChild = new ClpWorker(this, pWorker->evaluationPricers_[children.size()], 0, false);
+         pChild->solver_ = pWorker->solver_;
+         pChild->solver_.messageHandler()->setLogLevel(0);
+         pChild->solver_.addRow(vector, lhs[j], rhs[j]);
+         pChild->nbVarsInLP_ = pWorker->nbVarsInLP_;
+         pChild->pNode_ = new ClpNode(-1, pWorker->pNode_, pWorker->pNode_->lb_);
+         pChild->pNode_->rows_.push_back(ClpBranchingRow(indexCols, lhs[j], rhs[j], restDays[c]));
+         if(lhs[j] >= multiplicity)
+            pChild->pNode_->restDays_.push_back(restDays[c]);
+         else
+            pChild->pNode_->boundedDays_.push_back(restDays[c]);
+         children.push_back(pChild);
+      }
+   }
+
+   //evaluate them concurrently: the model is released while waiting
+   vector<double> bounds(nbChildren);
+   vector<exception_ptr> exceptions(nbChildren);
+   vector<thread> threads;
+   for(int i=0; i<nbChildren; ++i)
+      threads.push_back(thread(&ClpModeler::evaluateChild, this, children[i], &bounds[i], &exceptions[i]));
+   mutex_.unlock();
+   for(thread& th: threads)
+      th.join();
+   mutex_.lock();
+
+   for(ClpWorker* pChild: children){
+      delete pChild->pNode_;
+      delete pChild;
+   }
+   for(exception_ptr& e: exceptions)
+      if(e)
+         rethrow_exception(e);
+
+   //a child without bound (infeasible or not solved) gets a gain of -1 instead of LARGE_SCORE,
+   //which would dominate its pseudo-costs for the rest of the search
+   const double lb = pWorker->solver_.getObjValue();
+   gains.clear();
+   for(int c=0; c<restDays.size(); ++c){
+      double restGain = (bounds[2*c] < LARGE_SCORE) ? max(0.0, bounds[2*c]-lb) : -1;
+      double workGain = (bounds[2*c+1] < LARGE_SCORE) ? max(0.0, bounds[2*c+1]-lb) : -1;
+      gains.push_back(pair<double,double>(restGain, workGain));
+   }
+
+   return true;
+}
+
+void ClpModeler::setLastBranchingRest(pair<LiveNurse*, int> lastBranchingRest){
+   if(pCurrentWorker)
+      pCurrentWorker->lastBranchingRest_ = lastBranchingRest;
+   else
+      Modeler::setLastBranchingRest(lastBranchingRest);
+}
+
+pair<LiveNurse*, int> ClpModeler::getLastBranchingRest(){
+   if(pCurrentWorker)
+      return pCurrentWorker->lastBranchingRest_;
+   return Modeler::getLastBranchingRest();
+}
+
+/*
+ * Processing of the nodes
+ */
+
+void ClpModeler::runWorker(ClpWorker* pWorker){
+   pCurrentWorker = pWorker;
+   unique_lock<mutex> lock(mutex_);
+   try{
+      while(ClpNode* pNode = popNode(lock)){
+         //dive: the worker keeps processing the first child of its node
+         pWorker->pNode_ = pNode;
+         while(pWorker->pNode_ && !stop_){
+            if(isTimeUp())
+               throw FeasibleStop("Stopped: time limit reached.");
+            processNode(pWorker, lock);
+         }
+         //the search has been stopped during the dive
+         delete pWorker->pNode_;
+         pWorker->pNode_ = 0;
+         --nbActiveWorkers_;
+         //wake up the other workers if the tree is closed
+         if(nodes_.empty() && nbActiveWorkers_ == 0)
+            nodeAvailable_.notify_all();
+      }
+   }
+   catch(...){
+      if(!lock.owns_lock())
+         lock.lock();
+      delete pWorker->pNode_;
+      pWorker->pNode_ = 0;
+      --nbActiveWorkers_;
+      stopSearch(current_exception());
+   }
+   pCurrentWorker = 0;
+}
+
+void ClpModeler::processNode(ClpWorker* pWorker, unique_lock<mutex>& lock){
+   ClpNode* pNode = pWorker->pNode_;
+   OsiClpSolverInterface& solver = pWorker->solver_;
+
+   //the node is loaded first, so that the new resting arcs join its rest rows
+   loadNode(pWorker, pNode);
+   updateColumns(pWorker);
+   ++nbNodes_;
+   //one more node without new incumbent
+   ++nbNodesLastIncumbent_;
+
+   //column generation
+   bool feasible = true;
+   while(true){
+      lock.unlock();
+      solver.resolve();
+      lock.lock();
+
+      if(stop_)
+         return;
+      if(!solver.isProvenOptimal()){
+         feasible = false;
+         break;
+      }
+      storeLPSol(pWorker);
+      doStop();
+
+      //the other workers may have generated some columns too, but the column generation
+      //of the node is over only when its own pricing does not find any column
+      const int nbColumnsGenerated = pWorker->nbColumnsGenerated_;
+      if(pWorker->pPricer_)
+         pWorker->pPricer_->pricing(0, true);
+      printSummaryLine(pWorker, solver.getObjValue());
+      if(pWorker->nbColumnsGenerated_ == nbColumnsGenerated)
+         break;
+      updateColumns(pWorker);
+   }
+
+   if(feasible){
+      const double lb = solver.getObjValue();
+      pNode->updateLB(lb);
+
+      //if root and a variable with the obj LARGE_SCORE is positive -> INFEASIBLE
+      if(pNode->depth_ == 0){
+         best_lb_in_root = lb;
+         for(CoinVar* col: columnVars_)
+            if(col->getCost() == LARGE_SCORE && getVarValue(col) > EPSILON)
+               throw InfeasibleStop("Feasibility columns are still present in the solution");
+      }
+
+      //stop the search
+      doStop();
+
+      //fathom if greater than current upper bound, otherwise store the solution or branch
+      pWorker->pNode_ = 0;
+      if(best_ub - lb >= parameters_.absoluteGap_ - EPSILON){
+         if(isIntegerSol(pWorker))
+            addSolution(pWorker, lb);
+         else
+            branch(pWorker, pNode, lb);
+      }
+   }
+   else
+      pWorker->pNode_ = 0;
+
+   //end of the first dive
+   if(!pWorker->pNode_ && pNode->depth_ > 0 && diveLength_ == LARGE_SCORE)
+      diveLength_ = 1 + pNode->depth_;
+
+   delete pNode;
+}
+
+void ClpModeler::loadNode(ClpWorker* pWorker, ClpNode* pNode){
+   OsiClpSolverInterface& solver = pWorker->solver_;
+
+   //remove the branching constraints of the previous node
+   const int nbCons = cons_.size(), nbRows = solver.getNumRows();
+   if(nbRows > nbCons){
+      vector<int> rows(nbRows - nbCons);
+      for(int i=0; i<rows.size(); ++i)
+         rows[i] = nbCons + i;
+      solver.deleteRows(rows.size(), rows.data());
+   }
+
+   //restore the bounds changed by the previous node
+   for(int index: pWorker->boundedVars_){
+      CoinVar* var = getVar(index);
+      solver.setColBounds(index, var->getLB(), var->getUB());
+   }
+   pWorker->boundedVars_.clear();
+
+   //apply the decisions of the node
+   for(pair<const int, pair<double,double> >& p: pNode->varBounds_){
+      solver.setColBounds(p.first, p.second.first, p.second.second);
+      pWorker->boundedVars_.push_back(p.first);
+   }
+   for(ClpBranchingRow& row: pNode->rows_){
+      vector<int> indexCols;
+      getRowCols(pWorker, row, indexCols);
+      vector<double> coeffs(indexCols.size(), 1);
+      CoinPackedVector vector(indexCols.size(), indexCols.data(), coeffs.data());
+      solver.addRow(vector, row.lhs_, row.rhs_);
+   }
+}
+
+void ClpModeler::updateColumns(ClpWorker* pWorker){
+   const int first = pWorker->nbVarsInLP_ - coreVars_.size(), last = columnVars_.size();
+   const int nbColumns = last - first;
+   if(nbColumns <= 0)
+      return;
+
+   //the coefficients of the new columns are contiguous in the column storage
+   const int* indexRows = columnVars_[first]->getIndexRows();
+   const double* coeffs = columnVars_[first]->getCoeffRows();
+   vector<CoinBigIndex> starts(nbColumns+1);
+   vector<double> collb(nbColumns), colub(nbColumns), obj(nbColumns);
+   for(int c=0; c<nbColumns; ++c){
+      CoinVar* col = columnVars_[first+c];
+      starts[c] = col->getIndexRows() - indexRows;
+      collb[c] = col->getLB();
+      colub[c] = col->getUB();
+      obj[c] = col->getCost();
+   }
+   starts[nbColumns] = starts[nbColumns-1] + columnVars_[last-1]->getNbRows();
+
+   pWorker->solver_.addCols(nbColumns, starts.data(), indexRows, coeffs, collb.data(), colub.data(), obj.data());
+   const int firstIndex = pWorker->nbVarsInLP_;
+   pWorker->nbVarsInLP_ += nbColumns;
+
+   //the new resting arcs may cover a branched day of the node: they join its rest rows,
+   //otherwise the rest decision could be violated by arcs generated in another subtree
+   ClpNode* pNode = pWorker->pNode_;
+   if(!pNode)
+      return;
+   const int nbCons = cons_.size();
+   for(int r=0; r<pNode->rows_.size(); ++r){
+      vector<int> indexCols;
+      getRowCols(pWorker, pNode->rows_[r], indexCols);
+      for(int index: indexCols)
+         if(index >= firstIndex)
+            pWorker->solver_.modifyCoefficient(nbCons+r, index, 1);
+   }
+}
+
+void ClpModeler::getRowCols(ClpWorker* pWorker, ClpBranchingRow& row, vector<int>& indexCols){
+   if(!row.restDay_.first || !pBranchingRule_){
+      indexCols = row.indexCols_;
+      return;
+   }
+   //the branching rule of the modeler only reads the resting arcs of the master
+   vector<MyVar*> restVars;
+   pBranchingRule_->getRestVars(row.restDay_.first, row.restDay_.second, restVars);
+   for(MyVar* var: restVars){
+      const int index = ((CoinVar*) var)->getIndex();
+      if(index < pWorker->nbVarsInLP_)
+         indexCols.push_back(index);
+   }
+}
+
+void ClpModeler::storeLPSol(ClpWorker* pWorker){
+   OsiClpSolverInterface& solver = pWorker->solver_;
+   const int nbCols = solver.getNumCols(), nbCons = cons_.size();
+   pWorker->primalValues_.assign(solver.getColSolution(), solver.getColSolution()+nbCols);
+   pWorker->reducedCosts_.assign(solver.getReducedCost(), solver.getReducedCost()+nbCols);
+   pWorker->dualValues_.assign(solver.getRowPrice(), solver.getRowPrice()+nbCons);
+}
+
+bool ClpModeler::isIntegerSol(ClpWorker* pWorker){
+   for(int i=0; i<pWorker->primalValues_.size(); ++i){
+      CoinVar* var = getVar(i);
+      if(var->is_integer() && !isInteger(var))
+         return false;
+   }
+   return true;
+}
+
+void ClpModeler::addSolution(ClpWorker* pWorker, double obj){
+   //if no integer solution is needed, don't store the solutions
+   if(parameters_.stopAfterXSolution_ == 0)
+      return;
+
+   solutions_.push_back(pair<double, vector<double> >(obj, pWorker->primalValues_));
+
+   if(best_ub > obj + EPSILON){
+      setBestUB(obj);
+      //the values of the worker are the ones of the solution
+      PrintSolution* pSaveFunction = parameters_.printEverySolution_ ? parameters_.saveFunction_ : 0;
+      //in a portfolio, only the solutions improving the shared incumbent are saved
+      if(parameters_.pSharedIncumbent_)
+         parameters_.pSharedIncumbent_->update(obj, pSaveFunction, parameters_.weekIndices_, parameters_.outfile_);
+      else if(pSaveFunction)
+         pSaveFunction->save(parameters_.weekIndices_, parameters_.outfile_);
+   }
+}
+
+//Branch on the rest arcs of a day for a nurse: rest and work children.
+//Try also to fix to 1 some columns in a first child.
+//The worker keeps the first child (dive) and the others are pushed in the queue.
+bool ClpModeler::branch(ClpWorker* pWorker, ClpNode* pNode, double lb){
+   //the node stays the one of the worker while the branching rule evaluates its children
+   pWorker->pNode_ = pNode;
+
+   //branching candidates: rest on a day
+   vector<MyVar*> branchingCandidates;
+   if(pWorker->pRule_)
+      pWorker->pRule_->branching_candidates(branchingCandidates);
+
+   //fixing candidates: columns close to 1
+   vector<MyVar*> fixingCandidates;
+   if(pWorker->pRule_)
+      pWorker->pRule_->logical_fixing(fixingCandidates);
+
+   pWorker->pNode_ = 0;
+   if(branchingCandidates.size() == 0)
+      return false;
+
+   //the column generation is finished, so lb is a valid bound for the subtree
+   vector<int> fixedVars;
+   reducedCostFixing(pWorker, lb, fixedVars);
+
+   vector<ClpNode*> children;
+   if(fixingCandidates.size() > 0){
+      ClpNode* pChild = new ClpNode(nbNodesCreated_++, pNode, lb);
+      for(MyVar* var: fixingCandidates)
+         pChild->varBounds_[((CoinVar*) var)->getIndex()] = pair<double,double>(1, var->getUB());
+      children.push_back(pChild);
+   }
+
+   vector<int> indexCols;
+   for(MyVar* var: branchingCandidates)
+      indexCols.push_back(((CoinVar*) var)->getIndex());
+   //for a block of identical nurses, the rest child forces at least ceil(value) of them to rest
+   //and the work child at most floor(value)
+   const double multiplicity = pWorker->lastBranchingRest_.first->multiplicity_;
+   double restLb, workUb;
+   getRestBranchingBounds(branchingCandidates, restLb, workUb);
+   //rest on the day
+   ClpNode* pRestChild = new ClpNode(nbNodesCreated_++, pNode, lb);
+   pRestChild->rows_.push_back(ClpBranchingRow(indexCols, restLb, multiplicity, pWorker->lastBranchingRest_));
+   if(restLb >= multiplicity)
+      pRestChild->restDays_.push_back(pWorker->lastBranchingRest_);
+   else
+      pRestChild->boundedDays_.push_back(pWorker->lastBranchingRest_);
+   children.push_back(pRestChild);
+   //work on the day
+   ClpNode* pWorkChild = new ClpNode(nbNodesCreated_++, pNode, lb);
+   pWorkChild->rows_.push_back(ClpBranchingRow(indexCols, 0, workUb, pWorker->lastBranchingRest_));
+   pWorkChild->boundedDays_.push_back(pWorker->lastBranchingRest_);
+   children.push_back(pWorkChild);
+
+   shared_ptr<double> pSiblingsGap = make_shared<double>(0);
+   for(ClpNode* pChild: children){
+      pChild->pSiblingsGap_ = pSiblingsGap;
+      for(int index: fixedVars)
+         if(pChild->varBounds_.find(index) == pChild->varBounds_.end())
+            pChild->varBounds_[index] = pair<double,double>(0, 0);
+   }
+
+   pWorker->pNode_ = children[0];
+   for(int i=1; i<children.size(); ++i)
+      pushNode(children[i]);
+
+   return true;
+}
+
+void ClpModeler::reducedCostFixing(ClpWorker* pWorker, double lb, vector<int>& fixedVars){
+   //no incumbent
+   if(best_ub >= LARGE_SCORE - EPSILON)
+      return;
+
+   //a solution must be at least absoluteGap_ better than best_ub to improve it,
+   //and its cost is at least lb + the reduced cost of any variable set to 1
+   const double gap = best_ub - parameters_.absoluteGap_ - lb;
+   vector<double>& primalValues = pWorker->primalValues_;
+   vector<double>& reducedCosts = pWorker->reducedCosts_;
+   for(int index=coreVars_.size(); index<reducedCosts.size(); ++index)
+      if(primalValues[index] < EPSILON && reducedCosts[index] > gap + EPSILON)
+         fixedVars.push_back(index);
+   for(MyVar* var: fixableCoreVars_){
+      const int index = ((CoinVar*) var)->getIndex();
+      if(primalValues[index] < EPSILON && reducedCosts[index] > gap + EPSILON)
+         fixedVars.push_back(index);
+   }
+}
+
+void ClpModeler::evaluateChild(ClpWorker* pWorker, double* pBound, exception_ptr* pException){
+   pCurrentWorker = pWorker;
+   OsiClpSolverInterface& solver = pWorker->solver_;
+   unique_lock<mutex> lock(mutex_);
+   try{
+      *pBound = LARGE_SCORE;
+      for(int it=0; it<parameters_.strongBranchingIterations_ && !stop_ && !isTimeUp(); ++it){
+         lock.unlock();
+         solver.resolve();
+         lock.lock();
+
+         if(!solver.isProvenOptimal()){
+            *pBound = LARGE_SCORE;
+            break;
+         }
+         *pBound = solver.getObjValue();
+         storeLPSol(pWorker);
+
+         //the columns found are added to the model: they may be useful for the other nodes too
+         const int nbColumnsGenerated = pWorker->nbColumnsGenerated_;
+         pWorker->pPricer_->pricing(0, true);
+         if(pWorker->nbColumnsGenerated_ == nbColumnsGenerated)
+            break;
+         updateColumns(pWorker);
+      }
+   }
+   catch(...){
+      *pException = current_exception();
+   }
+   pCurrentWorker = 0;
+}
+
+/*
+ * Node queue
+ */
+
+void ClpModeler::pushNode(ClpNode* pNode){
+   nodes_.push_back(pNode);
+   nodeAvailable_.notify_one();
+}
+
+ClpNode* ClpModeler::popNode(unique_lock<mutex>& lock){
+   while(!stop_){
+      //no new node once the time limit is reached
+      if(isTimeUp()){
+         stopSearch(make_exception_ptr(FeasibleStop("Stopped: time limit reached.")));
+         return 0;
+      }
+
+      //prune the nodes which cannot improve the incumbent and choose the next one
+      ClpNode* pBest = 0;
+      int size = 0;
+      for(ClpNode* pNode: nodes_){
+         if(best_ub - pNode->lb_ < parameters_.absoluteGap_ - EPSILON){
+            delete pNode;
+            continue;
+         }
+         if(!pBest || isBefore(pNode, pBest))
+            pBest = pNode;
+         nodes_[size++] = pNode;
+      }
+      nodes_.resize(size);
+
+      if(pBest){
+         nodes_.erase(find(nodes_.begin(), nodes_.end(), pBest));
+         ++nbActiveWorkers_;
+         return pBest;
+      }
+
+      //the tree is closed
+      if(nbActiveWorkers_ == 0)
+         return 0;
+
+      nodeAvailable_.wait(lock);
+   }
+   return 0;
+}
+
+bool ClpModeler::isBefore(ClpNode* n1, ClpNode* n2){
+   switch(searchStrategy_){
+   case DepthFirstSearch:
+      if(n1->depth_ != n2->depth_)
+         return n1->depth_ > n2->depth_;
+      return n1->lb_ < n2->lb_;
+   case BreadthFirstSearch:
+      if(n1->depth_ != n2->depth_)
+         return n1->depth_ < n2->depth_;
+      return n1->lb_ < n2->lb_;
+   //the children of the branchings which have increased the most the bound first
+   case HighestGapFirst:
+      if(n1->getHighestGap() != n2->getHighestGap())
+         return n1->getHighestGap() > n2->getHighestGap();
+      return n1->lb_ < n2->lb_;
+   default:
+      if(n1->lb_ != n2->lb_)
+         return n1->lb_ < n2->lb_;
+      return n1->depth_ > n2->depth_;
+   }
+}
+
+double ClpModeler::getBestLB(){
+   double bestLB = LARGE_SCORE;
+   for(ClpNode* pNode: nodes_)
+      if(bestLB > pNode->lb_)
+         bestLB = pNode->lb_;
+   for(ClpWorker* pWorker: workers_)
+      if(pWorker->pNode_ && bestLB > pWorker->pNode_->lb_)
+         bestLB = pWorker->pNode_->lb_;
+   return bestLB;
+}
+
+//Check if the search must stop: same criteria as BcpModeler::doStop
+void ClpModeler::doStop(){
+   //get the incumbent of the other solvers of the portfolio
+   SharedIncumbent* pSharedIncumbent = parameters_.pSharedIncumbent_;
+   if(pSharedIncumbent){
+      if(pSharedIncumbent->isStopped())
+         throw FeasibleStop("Stopped: another solver of the portfolio has closed the gap.");
+      setBestUB(pSharedIncumbent->getBestUB());
+   }
+
+   //check the time limit
+   if(isTimeUp())
+      throw FeasibleStop("Stopped: time limit reached.");
+
+   //continue if doesn't have a lb
+   const double bestLB = getBestLB();
+   if(bestLB >= LARGE_SCORE)
+      return;
+
+   //check the cut-off
+   if(bestLB > parameters_.cutOff_ + EPSILON)
+      throw FeasibleStop("Stopped: the lower bound exceeds the cut-off.");
+
+   //check the number of solution
+   if(nbSolutions() >= parameters_.stopAfterXSolution_){
+      char error[100];
+      sprintf(error, "Stopped: %d solutions have been founded", nbSolutions());
+      throw FeasibleStop(error);
+   }
+
+   //check relative gap
+   if(parameters_.solveToOptimality_)
+      return;
+   else if(best_ub - bestLB < parameters_.minRelativeGap_ * bestLB - EPSILON){
+      char error[100];
+      sprintf(error, "Stopped: relative gap < %.2f.", parameters_.minRelativeGap_);
+      throw OptimalStop(error);
+   }
+   if(best_ub - bestLB < parameters_.relativeGap_ * bestLB - EPSILON){
+      //if the relative gap is small enough and if same incumbent since the last dive, stop
+      if(nbNodesLastIncumbent_ > parameters_.nbDiveIfMinGap_*diveLength_){
+         char error[100];
+         sprintf(error, "Stopped: relative gap < %.2f and more than %d nodes without new incumbent.",
+            parameters_.relativeGap_, parameters_.nbDiveIfMinGap_*diveLength_);
+         throw FeasibleStop(error);
+      }
+   }
+   else
+      //if the relative gap is too big, wait 2 dives before stopping
+      if(nbNodesLastIncumbent_ > parameters_.nbDiveIfRelGap_*diveLength_){
+         char error[100];
+         sprintf(error, "Stopped: relative gap > %.2f and more than %d nodes without new incumbent.",
+            parameters_.relativeGap_, parameters_.nbDiveIfRelGap_*diveLength_);
+         throw FeasibleStop(error);
+      }
+}
+
+void ClpModeler::stopSearch(exception_ptr e){
+   if(!stopException_)
+      stopException_ = e;
+   stop_ = true;
+   nodeAvailable_.notify_all();
+}
+
+//print in cout a line summary of the current solver state
+void ClpModeler::printSummaryLine(ClpWorker* pWorker, double obj){
+   if(verbosity_ <= 0)
+      return;
+
+   FILE * pFile;
+   pFile = logfile_.empty() ? stdout : fopen (logfile_.c_str(),"a");
+
+   /* compute number of fractional columns */
+   int frac = 0, non_zero = 0;
+   for(int i=coreVars_.size(); i<pWorker->primalValues_.size(); ++i){
+      double value = pWorker->primalValues_[i];
+      if(value < EPSILON)
+         continue;
+      non_zero ++;
+      if(value < 1 - EPSILON)
+         frac++;
+   }
+
+   fprintf(pFile,"CLP: %5d / %5d %5d | %10.0f %10.2f %10.2f | %10.2f %5d / %4d %10d | %5d \n",
+      pWorker->pNode_->index_, (int) nodes_.size(), pWorker->pNode_->depth_,
+      best_ub, best_lb_in_root, getBestLB(),
+      obj, frac, non_zero, pWorker->nbVarsInLP_ - (int) coreVars_.size(),
+      (int) (find(workers_.begin(), workers_.end(), pWorker) - workers_.begin()));
+
+   if (!logfile_.empty()) fclose(pFile);
+}
+
+/*
+ * Outputs
+ */
+
+bool ClpModeler::loadBestSol(){
+   int index = -1;
+   double bestObj = LARGE_SCORE;
+   for(int i=0; i<solutions_.size(); ++i)
+      if(solutions_[i].first < bestObj){
+         bestObj = solutions_[i].first;
+         index = i;
+      }
+   if(index == -1)
+      return false;
+
+   //the columns generated after the solution are at 0
+   primalValues_ = solutions_[index].second;
+   primalValues_.resize(getNbVars(), 0);
+   return true;
+}
+
+int ClpModeler::printStats(){
+   if(verbosity_ > 0)
+      printf("CLP: %d nodes processed, %d nodes created.\n", nbNodes_, nbNodesCreated_);
+   return 1;
+}
+
+int ClpModeler::writeLP(string fileName){
+   OsiClpSolverInterface solver;
+   loadProblem(solver);
+   solver.writeLp(fileName.c_str(), "lp", 1e-5, 10, 5);
+   return 1;
+}
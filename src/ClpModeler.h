@@ -0,0 +1,286 @@
+/*
+ * ClpModeler.h
+ *
+ *  Native branch-and-price on top of Clp:
+ *  the nodes are stored in a shared queue and processed by several worker threads,
+ *  each one with its own copy of the LP, its own pricer and its own branching rule.
+ *  The model (variables, constraints, columns) is shared and protected by a mutex,
+ *  which is released during the LP solves and the sub problem solves.
+ */
+
+#ifndef SRC_CLPMODELER_H_
+#define SRC_CLPMODELER_H_
+
+#include "CoinModeler.h"
+#include "OsiClpSolverInterface.hpp"
+#include "CoinTime.hpp"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+
+/*
+ * My Nodes
+ */
+
+//branching constraint on a set of core variables: lhs <= sum vars <= rhs
+struct ClpBranchingRow{
+   ClpBranchingRow(vector<int>& indexCols, double lhs, double rhs, pair<LiveNurse*, int> restDay = pair<LiveNurse*, int>(0, -1)):
+      indexCols_(indexCols), lhs_(lhs), rhs_(rhs), restDay_(restDay) { }
+
+   vector<int> indexCols_; //index of the variables of the row (coefficients are 1)
+   double lhs_, rhs_;
+   //rest decision of the row (0 if none): the resting arcs generated after the branching,
+   //possibly in another subtree or by another worker, belong to the row too
+   pair<LiveNurse*, int> restDay_;
+};
+
+//a node stores all the decisions taken from the root, so that it can be processed by any worker
+struct ClpNode{
+   ClpNode(): index_(0), depth_(0), lb_(LARGE_SCORE), parentLb_(LARGE_SCORE) { }
+
+   ClpNode(int index, ClpNode* pParent, double lb):
+      index_(index), depth_(pParent->depth_+1), lb_(lb), parentLb_(lb),
+      varBounds_(pParent->varBounds_), rows_(pParent->rows_), restDays_(pParent->restDays_), boundedDays_(pParent->boundedDays_) { }
+
+   //update the lower bound once the node is solved, and the highest gap of its siblings: see BcpNode::updateBestLB
+   void updateLB(double lb){
+      lb_ = lb;
+      if(pSiblingsGap_ && parentLb_ > EPSILON){
+         double gap = (lb_ - parentLb_)/parentLb_;
+         if(gap > *pSiblingsGap_) *pSiblingsGap_ = gap;
+      }
+   }
+
+   //highest gap between the bound of a solved child of the parent and the one of the parent (LARGE_SCORE for the root)
+   double getHighestGap() { return pSiblingsGap_ ? *pSiblingsGap_ : LARGE_SCORE; }
+
+   const int index_, depth_;
+   //lower bound: the one of the parent until the node is solved (LARGE_SCORE for the root)
+   double lb_, parentLb_;
+   //highest gap of the children of the parent, shared by the siblings (none for the root)
+   shared_ptr<double> pSiblingsGap_;
+
+   //bounds of the variables changed by the branching decisions (index of the var -> (lb, ub))
+   map<int, pair<double,double> > varBounds_;
+   //branching constraints
+   vector<ClpBranchingRow> rows_;
+   //days on which a nurse (or all the nurses of its block) has to rest: the work shifts of these days are forbidden for the nurse
+   vector<pair<LiveNurse*, int> > restDays_;
+   //other days on which the rests of a nurse are bounded: it has to work, or only a part of its block has to rest
+   vector<pair<LiveNurse*, int> > boundedDays_;
+};
+
+class ClpModeler;
+
+//everything a thread needs to process nodes on its own
+struct ClpWorker{
+   ClpWorker(ClpModeler* pModel, MyPricer* pPricer, MyBranchingRule* pRule, bool ownsHandlers);
+   ~ClpWorker();
+
+   ClpModeler* pModel_;
+   //pricer and branching rule of the worker: the first worker uses the ones of the modeler, the others own a clone
+   MyPricer* pPricer_;
+   MyBranchingRule* pRule_;
+   bool ownsHandlers_;
+
+   //own copy of the LP: the columns are the core variables and then the columns of the modeler in the same order
+   OsiClpSolverInterface solver_;
+   int nbVarsInLP_;
+   //variables whose bounds have been changed by the node loaded in the LP
+   vector<int> boundedVars_;
+
+   //node currently processed
+   ClpNode* pNode_;
+
+   //current LP solution, indexed by the index of the variables and of the core constraints
+   vector<double> primalValues_, dualValues_, reducedCosts_;
+
+   //number of columns created by this worker: used to know if its last pricing has found columns
+   int nbColumnsGenerated_;
+
+   //last branching decision on a rest day
+   pair<LiveNurse*, int> lastBranchingRest_;
+
+   //pricers of the children evaluated by strong branching (owned by the worker)
+   vector<MyPricer*> evaluationPricers_;
+};
+
+class ClpModeler: public CoinModeler {
+public:
+   ClpModeler(const char* name);
+   ~ClpModeler() { }
+
+   //solve the model
+   int solve(bool relaxation = false);
+
+   //Reset and clear solving parameters
+   void reset();
+
+   /*
+    * Create variable:
+    *    var is a pointer to the pointer of the variable
+    *    var_name is the name of the variable
+    *    lhs, rhs are the lower and upper bound of the variable
+    *    vartype is the type of the variable: VARTYPE_CONTINUOUS, VARTYPE_INTEGER, VARTYPE_BINARY
+    */
+   int createCoinVar(CoinVar** var, const char* var_name, int index, double objCoeff, VarType vartype, double lb, double ub);
+
+   int createColumnCoinVar(CoinVar** var, const char* var_name, int index, double objCoeff, double dualObj, VarType vartype, double lb, double ub);
+
+   /*
+    * Create linear constraint:
+    *    con is a pointer to the pointer of the constraint
+    *    con_name is the name of the constraint
+    *    lhs, rhs are the lower and upper bound of the constraint
+    */
+   int createCoinConsLinear(CoinCons** con, const char* con_name, int index, double lhs, double rhs);
+
+   /*
+    * Get the primal value and the dual variables:
+    * within a worker, they come from its current LP, otherwise from the loaded solution
+    */
+   double getVarValue(MyVar* var);
+
+   double getDual(MyCons* cons, bool transformed = false);
+
+   void setBestUB(double ub);
+
+   /*
+    * Shared data and branching decisions
+    */
+   void lock() { mutex_.lock(); }
+
+   void unlock() { mutex_.unlock(); }
+
+   void addForbidenShifts(LiveNurse* pNurse, set<pair<int,int> >& forbidenShifts);
+
+   void getBranchedDays(LiveNurse* pNurse, set<int>& days);
+
+   //the children are evaluated in parallel with a limited column generation on copies of the LP of the worker
+   bool evaluateRestBranching(vector<pair<LiveNurse*, int> >& restDays, vector<vector<MyVar*> >& restVars,
+      vector<pair<double,double> >& gains);
+
+   void setLastBranchingRest(pair<LiveNurse*, int> lastBranchingRest);
+
+   pair<LiveNurse*, int> getLastBranchingRest();
+
+   /**************
+    * Parameters *
+    *************/
+   int setVerbosity(int v) { verbosity_ = v; return 1; }
+
+   /**************
+    * Outputs *
+    *************/
+   double getObjective(){ return best_ub; }
+
+   double getRelaxedObjective() { return best_lb_in_root; }
+
+   int nbSolutions() { return solutions_.size(); }
+
+   double getObjective(int index) { return solutions_[index].first; }
+
+   bool loadBestSol();
+
+   int printStats();
+
+   int writeLP(string fileName);
+
+protected:
+   /*
+    * Processing of the nodes by the workers
+    */
+   //loop of a worker: take nodes in the queue until the tree is closed or the search stopped
+   void runWorker(ClpWorker* pWorker);
+
+   //column generation on the node of the worker, then fathoming or branching
+   //lock owns mutex_, which is released during the LP solves
+   void processNode(ClpWorker* pWorker, unique_lock<mutex>& lock);
+
+   //load the decisions of the node of the worker in its LP
+   void loadNode(ClpWorker* pWorker, ClpNode* pNode);
+
+   //add to the LP of the worker the columns generated since its last update (by any worker)
+   //and the new resting arcs to the rest rows of its node
+   void updateColumns(ClpWorker* pWorker);
+
+   //index of the columns of the branching row in the LP of the worker: all the current resting arcs for a rest decision
+   void getRowCols(ClpWorker* pWorker, ClpBranchingRow& row, vector<int>& indexCols);
+
+   //store the current LP solution of the worker
+   void storeLPSol(ClpWorker* pWorker);
+
+   //return true if all the integer variables are integer in the current LP solution of the worker
+   bool isIntegerSol(ClpWorker* pWorker);
+
+   //add the current LP solution of the worker as an incumbent
+   void addSolution(ClpWorker* pWorker, double obj);
+
+   //create the children of the node pNode. Return false if there is no branching candidate
+   bool branch(ClpWorker* pWorker, ClpNode* pNode, double lb);
+
+   //limited column generation on the child of the evaluation worker pWorker: store its bound (LARGE_SCORE if infeasible or not solved)
+   void evaluateChild(ClpWorker* pWorker, double* pBound, exception_ptr* pException);
+
+   //reduced cost fixing for the subtree: see BcpModeler::reducedCostFixing
+   void reducedCostFixing(ClpWorker* pWorker, double lb, vector<int>& fixedVars);
+
+   /*
+    * Node queue: all its methods have to be called with mutex_ locked
+    */
+   void pushNode(ClpNode* pNode);
+
+   //wait until a node is available; return 0 if the tree is closed or the search stopped
+   ClpNode* popNode(unique_lock<mutex>& lock);
+
+   //true if the node n1 has to be processed before the node n2 for the current search strategy
+   bool isBefore(ClpNode* n1, ClpNode* n2);
+
+   //best lower bound of the open nodes
+   double getBestLB();
+
+   //check the stopping criteria: throw the corresponding exception
+   void doStop();
+
+   //true if the time limit of the solve (wall clock) is reached
+   bool isTimeUp() { return CoinWallclockTime() - solveStartTime_ > parameters_.maxSolvingTimeSeconds_; }
+
+   //stop all the workers: the first exception is rethrown by solve
+   void stopSearch(exception_ptr e);
+
+   //print a line summary of the current solver state
+   void printSummaryLine(ClpWorker* pWorker, double obj);
+
+   //the mutex protecting the model, the node queue and the solutions
+   mutex mutex_;
+   condition_variable nodeAvailable_;
+
+   //open nodes and nodes currently processed by the workers
+   vector<ClpNode*> nodes_;
+   vector<ClpWorker*> workers_;
+   int nbActiveWorkers_, nbNodesCreated_, nbNodes_, nbNodesLastIncumbent_, diveLength_;
+   bool stop_;
+   exception_ptr stopException_;
+
+   //best lb in root
+   double best_lb_in_root;
+
+   //start of the current solve (wall clock, as the workers run concurrently)
+   double solveStartTime_;
+
+   //solutions found: objective and primal values
+   vector<pair<double, vector<double> > > solutions_;
+
+   //loaded solution (out of the workers)
+   vector<double> primalValues_;
+
+   inline CoinVar* getVar(int index){
+      const int nbCoreVars = coreVars_.size();
+      return (index < nbCoreVars) ? coreVars_[index] : columnVars_[index-nbCoreVars];
+   }
+};
+
+#endif /* SRC_CLPMODELER_H_ */
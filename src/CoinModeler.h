@@ -12,6 +12,8 @@
 
 /* Coin includes */
 #include <CoinPackedMatrix.hpp>
+#include <CoinHelperFunctions.hpp>
+#include <OsiSolverInterface.hpp>
 
 /*
  * My Constraints
@@ -39,17 +41,45 @@ protected:
    int index_; //index of the row of the matrix here
 };
 
+/*
+ * Column-major storage of the coefficients of the columns
+ * The coefficients of all the columns are stored contiguously in their order of creation,
+ * a column being just a view [start, start+size) on these arrays.
+ */
+struct CoinColumnStorage{
+   vector<int> indexRows_; //index of the rows of the non-zero coefficients
+   vector<double> coeffs_; //value of these coefficients
+
+   inline int size() { return indexRows_.size(); }
+
+   //grow geometrically to be able to store at least nbCoeffs coefficients
+   inline void reserve(int nbCoeffs){
+      if(nbCoeffs <= indexRows_.capacity())
+         return;
+      nbCoeffs = max(nbCoeffs, (int) (2*indexRows_.capacity()));
+      indexRows_.reserve(nbCoeffs);
+      coeffs_.reserve(nbCoeffs);
+   }
+
+   inline void push_back(int index, double coeff){
+      indexRows_.push_back(index);
+      coeffs_.push_back(coeff);
+   }
+};
+
 /*
  * My Variables
  */
 //Coin var, just a virtual class
 struct CoinVar: public MyVar {
    CoinVar(const char* name, int index, double cost, VarType type, double lb, double ub, double dualCost = 99999):
-      MyVar(name, cost, type, lb, ub), index_(index), dualCost_(dualCost)
+      MyVar(name, cost, type, lb, ub), index_(index), dualCost_(dualCost), pStorage_(0), start_(0), nbRows_(0)
    { }
 
+   //a copy of a column shares the storage of its coefficients
    CoinVar(const CoinVar& var) :
-      MyVar(var), index_(var.index_), dualCost_(var.dualCost_), indexRows_(var.indexRows_), coeffs_(var.coeffs_)
+      MyVar(var), index_(var.index_), dualCost_(var.dualCost_), indexRows_(var.indexRows_), coeffs_(var.coeffs_),
+      pStorage_(var.pStorage_), start_(var.start_), nbRows_(var.nbRows_)
    { }
 
    virtual ~CoinVar(){ }
@@ -58,35 +88,56 @@ struct CoinVar: public MyVar {
     * Setters and Getters
     */
 
+   //store the coefficients of the variable at the end of the column storage
+   void setStorage(CoinColumnStorage* pStorage){
+      pStorage_ = pStorage;
+      start_ = pStorage->size();
+      nbRows_ = 0;
+   }
+
    void addRow(int index, double coeff){
-      indexRows_.push_back(index);
-      coeffs_.push_back(coeff);
+      if(!pStorage_){
+         indexRows_.push_back(index);
+         coeffs_.push_back(coeff);
+      }
+      //the coefficients must stay contiguous in the storage
+      else if(start_+nbRows_ != pStorage_->size())
+         Tools::throwError("Only the last column created can get new coefficients.");
+      else{
+         pStorage_->push_back(index, coeff);
+         ++nbRows_;
+      }
    }
 
    void toString(vector<CoinCons*>& cons) {
-      cout << name_ << ":";
-      for(int i=0; i<indexRows_.size(); ++i)
-         cout << " " << cons[indexRows_[i]]->name_ << ":" << coeffs_[i];
+      cout << getName() << ":";
+      for(int i=0; i<getNbRows(); ++i)
+         cout << " " << cons[getIndexRow(i)]->getName() << ":" << getCoeffRow(i);
       cout << endl;
    }
 
    int getIndex() { return index_; }
 
-   int getNbRows() { return indexRows_.size(); }
+   int getNbRows() { return pStorage_ ? nbRows_ : indexRows_.size(); }
 
-   vector<int>& getIndexRows() { return indexRows_; }
+   //the arrays are valid as long as no column is created
+   const int* getIndexRows() { return pStorage_ ? pStorage_->indexRows_.data()+start_ : indexRows_.data(); }
 
-   int getIndexRow(int i) { return indexRows_[i]; }
+   int getIndexRow(int i) { return getIndexRows()[i]; }
 
-   vector<double>& getCoeffRows() { return coeffs_; }
+   const double* getCoeffRows() { return pStorage_ ? pStorage_->coeffs_.data()+start_ : coeffs_.data(); }
 
-   double getCoeffRow(int i) { return coeffs_[i]; }
+   double getCoeffRow(int i) { return getCoeffRows()[i]; }
 
 protected:
    int index_; //index of the column of the matrix here
    double dualCost_; //dualCost of the variable
+   //core variables get their coefficients row by row: they are stored in the variable
    vector<int> indexRows_; //index of the rows of the matrix where the variable has non-zero coefficient
    vector<double> coeffs_; //value of these coefficients
+   //columns get all their coefficients at creation: they are stored in the column storage of the modeler
+   CoinColumnStorage* pStorage_;
+   int start_, nbRows_;
 };
 
 class CoinModeler: public Modeler {
@@ -121,7 +172,7 @@ public:
 
       int index = coreVars_.size() + columnVars_.size();
       CoinVar* var2;
-      createCoinVar(&var2, var_name, index, objCoeff, vartype, lb, ub);
+      createCoinVar(&var2, nameToStore(var_name), index, objCoeff, vartype, lb, ub);
 
       coreVars_.push_back(var2);
       *var = var2;
@@ -137,7 +188,8 @@ public:
 
       int index = coreVars_.size() + columnVars_.size();
       CoinVar* var2;
-      createColumnCoinVar(&var2, var_name, index, objCoeff, dualObj, vartype, lb, ub);
+      createColumnCoinVar(&var2, nameToStore(var_name), index, objCoeff, dualObj, vartype, lb, ub);
+      var2->setStorage(&columnStorage_);
 
       columnVars_.push_back(var2);
       *var = var2;
@@ -145,6 +197,27 @@ public:
       return 1;
    }
 
+   //create all the columns of a batch and their coefficients at once
+   //the storages are grown only once and the coefficients are directly added to the column storage
+   void createColumns(vector<MyVar*>& vars, VarType vartype, vector<string>& names,
+      vector<double>& objCoeffs, vector<double>& dualObjs,
+      vector<int>& starts, vector<MyCons*>& cons, vector<double>& coeffs){
+      const int nbColumns = objCoeffs.size();
+      const double ub = (vartype == VARTYPE_BINARY) ? 1.0 : DBL_MAX;
+
+      if(columnVars_.size()+nbColumns > columnVars_.capacity())
+         columnVars_.reserve(max(columnVars_.size()+nbColumns, 2*columnVars_.capacity()));
+      columnStorage_.reserve(columnStorage_.size()+coeffs.size());
+
+      vars.resize(nbColumns);
+      for(int c=0; c<nbColumns; ++c){
+         createColumnVar(&vars[c], names.empty() ? 0 : names[c].c_str(), objCoeffs[c], dualObjs[c], 0.0, ub, vartype, 0);
+         CoinVar* var = (CoinVar*) vars[c];
+         for(int i=starts[c]; i<starts[c+1]; ++i)
+            var->addRow(((CoinCons*) cons[i])->getIndex(), coeffs[i]);
+      }
+   }
+
    /*
     * Create linear constraint:
     *    con is a pointer to the pointer of the constraint
@@ -167,7 +240,7 @@ public:
 
       int index = cons_.size();
       CoinCons* con2;
-      createCoinConsLinear(&con2, con_name, index, lhs, rhs);
+      createCoinConsLinear(&con2, nameToStore(con_name), index, lhs, rhs);
 
       for(int i=0; i<vars.size(); ++i)
          addCoefLinear(con2, vars[i], coeffs[i]);
@@ -206,36 +279,71 @@ public:
 
    CoinPackedMatrix buildCoinMatrix(bool justCore = false){
       //define nb rows and col
-      const int corenum = coreVars_.size();
+      const int rownum = cons_.size(), corenum = coreVars_.size();
       const int colnum = (justCore) ? corenum : corenum + columnVars_.size();
 
-      //define a matrix as a vector of tuples (row_index, col_index, coeff)
-      vector<int> row_indices, col_indices;
-      vector<double> coeffs;
-
-      for(int i=0; i<colnum; ++i){
-         CoinVar* var(0);
-         //copy of the core variables
-         if(i<corenum)
-            var = coreVars_[i];
-         //copy of the column variables
-         else
-            var = columnVars_[i-corenum];
-
-         //build the tuples of the matrix
-         for(int j=0; j<var->getNbRows(); ++j){
-            row_indices.push_back(var->getIndexRow(j));
-            col_indices.push_back(var->getIndex());
-            coeffs.push_back(var->getCoeffRow(j));
+      //count the coefficients to allocate the arrays only once
+      CoinBigIndex numels = 0;
+      for(CoinVar* var: coreVars_)
+         numels += var->getNbRows();
+      const CoinBigIndex corenumels = numels;
+      if(!justCore)
+         numels += columnStorage_.size();
+
+      //build directly the column-major arrays, they will be owned by the matrix
+      double* elements = new double[numels];
+      int* indices = new int[numels];
+      CoinBigIndex* starts = new CoinBigIndex[colnum+1];
+      int* lengths = new int[colnum];
+
+      //copy of the core variables
+      CoinBigIndex start = 0;
+      for(int i=0; i<corenum; ++i){
+         CoinVar* var = coreVars_[i];
+         const int size = var->getNbRows();
+         CoinDisjointCopyN(var->getCoeffRows(), size, elements+start);
+         CoinDisjointCopyN(var->getIndexRows(), size, indices+start);
+         starts[i] = start;
+         lengths[i] = size;
+         start += size;
+      }
+
+      //copy of the column variables: they are already contiguous in the storage
+      if(!justCore){
+         CoinDisjointCopyN(columnStorage_.coeffs_.data(), columnStorage_.size(), elements+corenumels);
+         CoinDisjointCopyN(columnStorage_.indexRows_.data(), columnStorage_.size(), indices+corenumels);
+         for(int i=corenum; i<colnum; ++i){
+            CoinVar* var = columnVars_[i-corenum];
+            starts[i] = corenumels + (var->getIndexRows() - columnStorage_.indexRows_.data());
+            lengths[i] = var->getNbRows();
          }
       }
+      starts[colnum] = numels;
 
-      //initialize the matrix
-      CoinPackedMatrix matrix(false, &(row_indices[0]), &(col_indices[0]), &(coeffs[0]), row_indices.size());
+      //initialize the matrix without copying the arrays
+      CoinPackedMatrix matrix;
+      matrix.assignMatrix(true, rownum, colnum, numels, elements, indices, starts, lengths);
 
       return matrix;
    }
 
+   //load all the variables and the core constraints of the model in the solver
+   void loadProblem(OsiSolverInterface& solver){
+      const int corenum = coreVars_.size(), nbVars = getNbVars(), nbCons = cons_.size();
+      vector<double> collb(nbVars), colub(nbVars), obj(nbVars), rowlb(nbCons), rowub(nbCons);
+      for(int i=0; i<nbVars; ++i){
+         CoinVar* var = (i < corenum) ? coreVars_[i] : columnVars_[i-corenum];
+         collb[i] = var->getLB();
+         colub[i] = var->getUB();
+         obj[i] = var->getCost();
+      }
+      for(int i=0; i<nbCons; ++i){
+         rowlb[i] = cons_[i]->getLhs();
+         rowub[i] = cons_[i]->getRhs();
+      }
+      solver.loadProblem(buildCoinMatrix(), collb.data(), colub.data(), obj.data(), rowlb.data(), rowub.data());
+   }
+
    /*
     * Get the primal value
     */
@@ -259,11 +367,14 @@ public:
 
    //compute the total cost of a var*
    double getTotalCost(MyVar* var, bool print = false){
+      //the variables of the nurses aggregated in the block of another nurse do not exist
+      if(!var)
+         return 0;
       CoinVar* var2 = (CoinVar*) var;
 
       double value = getVarValue(var);
       if(print && value>EPSILON)
-         cout << var->name_ << ": " << value << "*" << var2->getCost() << endl;
+         cout << var->getName() << ": " << value << "*" << var2->getCost() << endl;
       return value *  var2->getCost();
    }
 
@@ -298,13 +409,13 @@ public:
          for(CoinVar* var: coreVars_){
             double value = getVarValue(var);
             if( value > tolerance)
-               fprintf(pFile,"%-30s %4.2f (%6.0f) \n", var->name_ , value, var->getCost());
+               fprintf(pFile,"%-30s %4.2f (%6.0f) \n", var->getName().c_str() , value, var->getCost());
          }
          //iterate on column variables
          for(CoinVar* var: columnVars_){
             double value = getVarValue(var);
             if( value > tolerance)
-               fprintf(pFile,"%-30s %4.2f (%6.0f) \n", var->name_ , value, var->getCost());
+               fprintf(pFile,"%-30s %4.2f (%6.0f) \n", var->getName().c_str() , value, var->getCost());
          }
 
          fprintf(pFile,"\n");
@@ -351,6 +462,9 @@ protected:
    vector<CoinVar*> coreVars_;
    vector<CoinVar*> columnVars_;
    vector<CoinCons*> cons_;
+
+   //contiguous storage of the coefficients of the columns
+   CoinColumnStorage columnStorage_;
 };
 
 #endif /* SRC_COINMODELER_H_ */
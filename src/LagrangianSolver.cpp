@@ -0,0 +1,343 @@
+/*
+ * LagrangianSolver.cpp
+ *
+ *  Lower bound of the master problem by Lagrangian relaxation: see LagrangianSolver.h
+ */
+
+#include "LagrangianSolver.h"
+
+//penalty of the rotations that do not start on the first day priced by the sub problem
+static const double START_PENALTY = 1.0e6;
+
+LagrangianSolver::LagrangianSolver(Scenario* pScenario, Demand* pDemand, Preferences* pPreferences, vector<State>* pInitState):
+   Solver(pScenario, pDemand, pPreferences, pInitState), positionsPerSkill_(pScenario->nbSkills_),
+   coverageMultipliers_(pDemand->nbDays_, vector< vector<double> >(pScenario->nbShifts_-1, vector<double>(pScenario->nbPositions(), 0)))
+{
+   this->preprocessData();
+
+   //link the skills to the positions
+   for(int p=0; p<pScenario_->nbPositions(); p++)
+      for(int sk: pScenario_->pPositions()[p]->skills_)
+         positionsPerSkill_[sk].push_back(p);
+}
+
+LagrangianSolver::~LagrangianSolver(){
+   for(pair<const Contract* const, SubProblem*>& p: subProblems_)
+      delete p.second;
+}
+
+//compute the bound with the subgradient algorithm
+double LagrangianSolver::solve(vector<Roster> solution){
+   return subgradient();
+}
+
+double LagrangianSolver::solve(SolverParam parameters, vector<Roster> solution){
+   param_ = parameters;
+   return solve(solution);
+}
+
+//build the relaxed constraints on the totals, as in MasterProblem::buildMinMaxCons
+//the multipliers of the last solve are kept if the constraints are the same
+void LagrangianSolver::buildTotalCons(){
+   vector<LagrangianCons> previousCons = totalCons_;
+   totalCons_.clear();
+
+   for(int i=0; i<pScenario_->nbNurses_; i++){
+      LiveNurse* pNurse = theLiveNurses_[i];
+      vector<int> nurses = {i};
+
+      const int minCons = totalCons_.size();
+      totalCons_.push_back(LagrangianCons(nurses, false, 1, minTotalShifts_[i], weightTotalShiftsMin_[i]));
+      const int maxCons = totalCons_.size();
+      totalCons_.push_back(LagrangianCons(nurses, false, -1, maxTotalShifts_[i], weightTotalShiftsMax_[i]));
+
+      //the averaged bounds share the slack of the bounds above
+      if (!minTotalShiftsAvg_.empty() && !maxTotalShiftsAvg_.empty() && !weightTotalShiftsAvg_.empty()) {
+         if (minTotalShiftsAvg_[i] > minTotalShifts_[i])
+            totalCons_.push_back(LagrangianCons(nurses, false, 1, minTotalShiftsAvg_[i],
+               min(weightTotalShiftsAvg_[i], weightTotalShiftsMin_[i]), minCons));
+         if (maxTotalShiftsAvg_[i] < maxTotalShifts_[i])
+            totalCons_.push_back(LagrangianCons(nurses, false, -1, maxTotalShiftsAvg_[i],
+               min(weightTotalShiftsAvg_[i], weightTotalShiftsMax_[i]), maxCons));
+      }
+
+      const int weekendCons = totalCons_.size();
+      totalCons_.push_back(LagrangianCons(nurses, true, -1, maxTotalWeekends_[i], weightTotalWeekendsMax_[i]));
+      if ( !maxTotalWeekendsAvg_.empty()  && !weightTotalWeekendsAvg_.empty()
+         && maxTotalWeekendsAvg_[i] < pNurse->maxTotalWeekends() - pNurse->pStateIni_->totalWeekendsWorked_)
+         totalCons_.push_back(LagrangianCons(nurses, true, -1, maxTotalWeekendsAvg_[i] - pNurse->pStateIni_->totalWeekendsWorked_,
+            min(weightTotalWeekendsAvg_[i], weightTotalWeekendsMax_[i]), weekendCons));
+   }
+
+   for(int p=0; p<pScenario_->nbContracts_; ++p){
+      vector<int> nurses;
+      for(int i=0; i<pScenario_->nbNurses_; i++)
+         if(theLiveNurses_[i]->pContract_->id_ == p)
+            nurses.push_back(i);
+
+      if(!minTotalShiftsContractAvg_.empty() && !maxTotalShiftsContractAvg_.empty()  && !weightTotalShiftsContractAvg_.empty()){
+         totalCons_.push_back(LagrangianCons(nurses, false, 1, minTotalShiftsContractAvg_[p], weightTotalShiftsContractAvg_[p]));
+         totalCons_.push_back(LagrangianCons(nurses, false, -1, maxTotalShiftsContractAvg_[p], weightTotalShiftsContractAvg_[p]));
+      }
+      if(!maxTotalWeekendsContractAvg_.empty()  && !weightTotalWeekendsContractAvg_.empty())
+         totalCons_.push_back(LagrangianCons(nurses, true, -1, maxTotalWeekendsContractAvg_[p], weightTotalWeekendsContractAvg_[p]));
+   }
+
+   //warm start with the previous multipliers, within the new bounds
+   if(previousCons.size() == totalCons_.size())
+      for(int c=0; c<totalCons_.size(); ++c)
+         totalCons_[c].multiplier_ = min(previousCons[c].multiplier_, totalCons_[c].ub_);
+   for(LagrangianCons& cons: totalCons_)
+      if(cons.coupledCons_ >= 0)
+         totalCons_[cons.coupledCons_].multiplier_ = min(totalCons_[cons.coupledCons_].multiplier_,
+            totalCons_[cons.coupledCons_].ub_ - cons.multiplier_);
+}
+
+//value of the Lagrangian function for the current multipliers and its subgradient
+double LagrangianSolver::evaluate(vector< vector< vector<double> > >& coverageSubgradient, vector<double>& totalSubgradient){
+   const int nbDays = pDemand_->nbDays_;
+   double value = 0;
+
+   //constant terms, and duals of the totals for each nurse
+   vector<double> workDuals(pScenario_->nbNurses_, 0), weekendDuals(pScenario_->nbNurses_, 0);
+   for(LagrangianCons& cons: totalCons_){
+      value += cons.multiplier_ * cons.sign_ * cons.rhs_;
+      for(int i: cons.nurses_)
+         (cons.isWeekend_ ? weekendDuals[i] : workDuals[i]) += cons.multiplier_ * cons.sign_;
+   }
+
+   //coverage part: the demand of each skill is covered by the cheapest position,
+   //up to the optimal demand if it is cheaper than the penalty of the optimal demand
+   coverageSubgradient.assign(nbDays, vector< vector<double> >(pScenario_->nbShifts_-1, vector<double>(pScenario_->nbPositions(), 0)));
+   for(int k=0; k<nbDays; k++)
+      for(int s=1; s<pScenario_->nbShifts_; s++)
+         for(int sk=0; sk<pScenario_->nbSkills_; sk++){
+            int bestPosition = -1;
+            double bestMultiplier = DBL_MAX;
+            for(int p: positionsPerSkill_[sk])
+               if(coverageMultipliers_[k][s-1][p] < bestMultiplier){
+                  bestMultiplier = coverageMultipliers_[k][s-1][p];
+                  bestPosition = p;
+               }
+            const int minDemand = pDemand_->minDemand_[k][s][sk], optDemand = pDemand_->optDemand_[k][s][sk];
+            //no nurse has the skill
+            if(bestPosition < 0){
+               value += optDemand * WEIGHT_OPTIMAL_DEMAND;
+               continue;
+            }
+            const int nbNurses = (bestMultiplier < WEIGHT_OPTIMAL_DEMAND) ? max(minDemand, optDemand) : minDemand;
+            value += nbNurses * bestMultiplier + max(0, optDemand - nbNurses) * WEIGHT_OPTIMAL_DEMAND;
+            coverageSubgradient[k][s-1][bestPosition] += nbNurses;
+         }
+
+   //part of each nurse
+   vector<int> workedDays(pScenario_->nbNurses_), workedWeekends(pScenario_->nbNurses_);
+   for(int i=0; i<pScenario_->nbNurses_; i++){
+      LiveNurse* pNurse = theLiveNurses_[i];
+      map<int,int> shifts;
+      value += solveNurse(pNurse, workDuals[i], weekendDuals[i], shifts);
+
+      workedDays[i] = shifts.size();
+      workedWeekends[i] = 0;
+      for(pair<const int,int>& p: shifts){
+         coverageSubgradient[p.first][p.second-1][pNurse->pPosition_->id_] -= 1;
+         //a weekend is counted on its saturday, or on its sunday if the saturday is not worked
+         if(Tools::isSaturday(p.first) || (Tools::isSunday(p.first) && !shifts.count(p.first-1)))
+            ++workedWeekends[i];
+      }
+   }
+
+   totalSubgradient.resize(totalCons_.size());
+   for(int c=0; c<totalCons_.size(); ++c){
+      double total = 0;
+      for(int i: totalCons_[c].nurses_)
+         total += totalCons_[c].isWeekend_ ? workedWeekends[i] : workedDays[i];
+      totalSubgradient[c] = totalCons_[c].sign_ * (totalCons_[c].rhs_ - total);
+   }
+
+   return value;
+}
+
+//shortest path in the rotation network of the nurse for the current multipliers
+//the network is the one of MasterProblem::buildRotationCons: the rest node k starts a rest on day k (k=0 is the source)
+//and the work node k can start a rotation on day k (k=nbDays is the sink)
+double LagrangianSolver::solveNurse(LiveNurse* pNurse, double workDual, double weekendDual, map<int,int>& shifts){
+   const int nbDays = pDemand_->nbDays_, p = pNurse->pPosition_->id_;
+
+   //dual costs of the sub problem: the coverage multipliers of the position of the nurse and the duals of its totals
+   vector< vector<double> > workDualCosts(nbDays, vector<double>(pScenario_->nbShifts_-1));
+   for(int k=0; k<nbDays; ++k)
+      for(int s=1; s<pScenario_->nbShifts_; ++s)
+         workDualCosts[k][s-1] = coverageMultipliers_[k][s-1][p] + workDual;
+   vector<Rotation> rotations;
+   vector< vector<int> > best = bestRotations(pNurse, workDualCosts, weekendDual, rotations);
+
+   //rest network, as in MasterProblem::buildRotationCons
+   const int minConsDaysOff(pNurse->minConsDaysOff()), maxConsDaysOff(pNurse->maxConsDaysOff()),
+      initConsDaysOff(pNurse->pStateIni_->consDaysOff_);
+   const bool maxRest = (maxConsDaysOff < nbDays + initConsDaysOff);
+   const int nbLongRestingArcs = maxRest ? maxConsDaysOff : minConsDaysOff;
+   const int firstRestArc = min( max( 0, nbLongRestingArcs - initConsDaysOff ), nbDays-1 );
+   const int indexStartRestArc = max(1, firstRestArc);
+   const int nbMinRestArcs = max(0, minConsDaysOff - initConsDaysOff);
+
+   //cost of the end of the rotation of the initial state, as in MasterProblem::computeInitStateRotation
+   double initCost = 0;
+   const int lastShift = pNurse->pStateIni_->shift_;
+   if(lastShift > 0){
+      initCost += max(0, pNurse->minConsDaysWork() - pNurse->pStateIni_->consDaysWorked_) * WEIGHT_CONS_DAYS_WORK;
+      initCost += max(0, pScenario_->minConsShifts_[lastShift] - pNurse->pStateIni_->consShifts_) * WEIGHT_CONS_SHIFTS;
+   }
+
+   //nodes: rest node k -> k, work node k -> nbDays+k
+   //for each node, its distance and its predecessor (node, index of the rotation or -1 for a rest)
+   vector<double> dist(2*nbDays+1, DBL_MAX);
+   vector< pair<int,int> > pred(2*nbDays+1, pair<int,int>(-1,-1));
+   dist[0] = 0;
+   auto relax = [&](int from, int to, double cost, int rotation){
+      if(dist[from] < DBL_MAX && dist[from] + cost < dist[to]){
+         dist[to] = dist[from] + cost;
+         pred[to] = pair<int,int>(from, rotation);
+      }
+   };
+
+   for(int k=1; k<=nbDays; ++k){
+      //rotations finishing on day k-1: they lead to the rest node k (or to the sink)
+      const int endNode = (k == nbDays) ? 2*nbDays : k;
+      for(int j=0; j<k; ++j)
+         if(best[j][k-1] >= 0)
+            relax((j == 0) ? 0 : nbDays+j, endNode, rotations[best[j][k-1]].dualCost_, best[j][k-1]);
+
+      //long resting arcs of length l finishing on day k-1: they lead to the work node k
+      for(int l=1; l<=k; ++l){
+         const int m = k-l;
+         double cost;
+         if(m == 0){
+            if(firstRestArc == 0){
+               if(l > 1) continue;
+               cost = (maxRest ? WEIGHT_CONS_DAYS_OFF : 0) + initCost;
+            }
+            else if(l <= nbMinRestArcs && l <= indexStartRestArc)
+               cost = (nbMinRestArcs - l) * WEIGHT_CONS_DAYS_OFF + initCost;
+            else if(maxRest && l <= firstRestArc)
+               cost = initCost;
+            else
+               continue;
+         }
+         else{
+            if(l > nbLongRestingArcs) continue;
+            //if the arc finishes the last day, the cost is 0. Indeed it will be computed on the next planning
+            cost = (l >= nbDays-m || l > minConsDaysOff) ? 0 : (minConsDaysOff - l) * WEIGHT_CONS_DAYS_OFF;
+         }
+         relax(m, nbDays+k, cost, -1);
+      }
+
+      //short resting arc on day k-1
+      if(k-1 >= indexStartRestArc)
+         relax(nbDays+k-1, nbDays+k, maxRest ? WEIGHT_CONS_DAYS_OFF : 0, -1);
+   }
+
+   //worked shifts of the path
+   shifts.clear();
+   for(int node = 2*nbDays; pred[node].first >= 0; node = pred[node].first)
+      if(pred[node].second >= 0)
+         for(pair<const int,int>& p: rotations[pred[node].second].shifts_)
+            shifts.insert(p);
+
+   return dist[2*nbDays];
+}
+
+//best rotation of the nurse for each first and last day (index in rotations, -1 if none):
+//the sub problem is solved for each first day, the other ones being penalized
+vector< vector<int> > LagrangianSolver::bestRotations(LiveNurse* pNurse, vector< vector<double> >& workDualCosts, double weekendDual,
+   vector<Rotation>& rotations){
+   const int nbDays = pDemand_->nbDays_;
+   vector< vector<int> > best(nbDays, vector<int>(nbDays, -1));
+
+   SubProblem*& pSubProblem = subProblems_[pNurse->pContract_];
+   if(!pSubProblem)
+      pSubProblem = new SubProblem(pScenario_, nbDays, pNurse->pContract_, pInitState_);
+
+   vector<SolveOption> options = {SOLVE_ONE_SINK_PER_LAST_DAY, SOLVE_SHORT_ALL};
+   vector<double> endWorkDualCosts(nbDays, 0);
+   for(int j=0; j<nbDays; ++j){
+      vector<double> startWorkDualCosts(nbDays, -START_PENALTY);
+      startWorkDualCosts[j] = 0;
+      DualCosts dualCosts (workDualCosts, startWorkDualCosts, endWorkDualCosts, weekendDual, true);
+      pSubProblem->solve(pNurse, &dualCosts, options, EMPTY_FORBIDDEN_LIST, true, 120, START_PENALTY/2);
+
+      for(Rotation& rot: pSubProblem->getRotations()){
+         if(rot.firstDay_ != j)
+            continue;
+         const int l = rot.firstDay_ + rot.length_ - 1;
+         if(best[j][l] < 0 || rot.dualCost_ < rotations[best[j][l]].dualCost_){
+            best[j][l] = rotations.size();
+            rotations.push_back(rot);
+         }
+      }
+   }
+
+   return best;
+}
+
+//subgradient iterations from the current multipliers, with a Polyak step towards a target above the best bound
+//the step factor is halved when the bound has not improved for a few iterations
+double LagrangianSolver::subgradient(){
+   Tools::Timer timer(true);
+   timer.init();
+   timer.start();
+
+   buildTotalCons();
+
+   double bestBound = -LARGE_SCORE, stepFactor = 2.0;
+   int nbIterationsWithoutImprovement = 0;
+   vector< vector< vector<double> > > coverageSubgradient;
+   vector<double> totalSubgradient;
+   for(int it=0; it<param_.lagrangianIterations_; ++it){
+      const double value = evaluate(coverageSubgradient, totalSubgradient);
+      if(value > bestBound + EPSILON){
+         bestBound = value;
+         nbIterationsWithoutImprovement = 0;
+      }
+      else if(++nbIterationsWithoutImprovement >= 5){
+         stepFactor /= 2;
+         nbIterationsWithoutImprovement = 0;
+      }
+
+      //the components that would move a multiplier out of its bounds are ignored
+      double norm = 0;
+      for(int k=0; k<coverageSubgradient.size(); ++k)
+         for(int s=0; s<coverageSubgradient[k].size(); ++s)
+            for(int p=0; p<coverageSubgradient[k][s].size(); ++p){
+               double& g = coverageSubgradient[k][s][p];
+               if(coverageMultipliers_[k][s][p] <= 0 && g < 0) g = 0;
+               norm += g*g;
+            }
+      for(int c=0; c<totalCons_.size(); ++c){
+         double& g = totalSubgradient[c];
+         if((totalCons_[c].multiplier_ <= 0 && g < 0) || (totalCons_[c].multiplier_ >= totalCons_[c].ub_ && g > 0)) g = 0;
+         norm += g*g;
+      }
+
+      if(norm < EPSILON || stepFactor < 1.0e-3 || timer.dSinceStart() > param_.maxSolvingTimeSeconds_
+         || bestBound > param_.cutOff_ + EPSILON)
+         break;
+
+      const double target = bestBound + max(1.0, 0.05*fabs(bestBound));
+      const double step = stepFactor * (target - value) / norm;
+      for(int k=0; k<coverageSubgradient.size(); ++k)
+         for(int s=0; s<coverageSubgradient[k].size(); ++s)
+            for(int p=0; p<coverageSubgradient[k][s].size(); ++p)
+               coverageMultipliers_[k][s][p] = max(0.0, coverageMultipliers_[k][s][p] + step * coverageSubgradient[k][s][p]);
+      for(int c=0; c<totalCons_.size(); ++c)
+         totalCons_[c].multiplier_ = min(totalCons_[c].ub_, max(0.0, totalCons_[c].multiplier_ + step * totalSubgradient[c]));
+      for(LagrangianCons& cons: totalCons_)
+         if(cons.coupledCons_ >= 0)
+            totalCons_[cons.coupledCons_].multiplier_ = min(totalCons_[cons.coupledCons_].multiplier_,
+               totalCons_[cons.coupledCons_].ub_ - cons.multiplier_);
+   }
+
+   timer.stop();
+   status_ = FEASIBLE;
+   return bestBound;
+}
@@ -0,0 +1,78 @@
+/*
+ * LagrangianSolver.h
+ *
+ *  Lower bound of the master problem computed by a subgradient algorithm on the Lagrangian relaxation
+ *  of the skills coverage constraints and of the constraints on the total numbers of worked days and weekends.
+ *  No LP is built: for given multipliers, the coverage part is solved in closed form, and the part of each nurse
+ *  is a shortest path in its rotation network (the one of the master problem), whose rotation arcs are the best
+ *  rotations between two days, computed by the sub problem of the column generation.
+ */
+
+#ifndef SRC_LAGRANGIANSOLVER_H_
+#define SRC_LAGRANGIANSOLVER_H_
+
+#include "Solver.h"
+#include "MasterProblem.h"
+#include "SubProblem.h"
+
+//constraint on the total number of worked days (or weekends) of a set of nurses, relaxed with a multiplier
+//a min constraint (sign_=1) bounds rhs_ - total, a max constraint (sign_=-1) bounds total - rhs_:
+//the violation costs at least multiplier_ * sign_ * (rhs_ - total) if 0 <= multiplier_ <= ub_
+struct LagrangianCons{
+   LagrangianCons(vector<int> nurses, bool isWeekend, double sign, double rhs, double ub, int coupledCons = -1):
+      nurses_(nurses), isWeekend_(isWeekend), sign_(sign), rhs_(rhs), ub_(ub), coupledCons_(coupledCons), multiplier_(0) { }
+
+   vector<int> nurses_;
+   bool isWeekend_;
+   double sign_, rhs_, ub_;
+   //averaged bound sharing the slack of another constraint (-1 if none):
+   //the sum of their multipliers is bounded by the ub_ of the other constraint
+   int coupledCons_;
+   double multiplier_;
+};
+
+class LagrangianSolver: public Solver {
+public:
+   LagrangianSolver(Scenario* pScenario, Demand* pDemand, Preferences* pPreferences, vector<State>* pInitState);
+   ~LagrangianSolver();
+
+   //compute the bound with the subgradient algorithm
+   double solve(vector<Roster> solution = {});
+
+   //a resolve with another demand of the same size starts from the multipliers of the last solve
+   double solve(SolverParam parameters, vector<Roster> solution = {});
+
+protected:
+   SolverParam param_;
+
+   //link positions to skills
+   vector2D positionsPerSkill_;
+
+   //sub problem of each contract
+   map<const Contract*, SubProblem*> subProblems_;
+
+   //multipliers of the coverage of each day, shift (shift 0 excluded) and position
+   vector< vector< vector<double> > > coverageMultipliers_;
+
+   //relaxed constraints on the totals: built on each solve, as the bounds and the weights are set after the construction
+   vector<LagrangianCons> totalCons_;
+
+   //build the relaxed constraints on the totals, as in MasterProblem::buildMinMaxCons
+   void buildTotalCons();
+
+   //value of the Lagrangian function for the current multipliers and its subgradient
+   double evaluate(vector< vector< vector<double> > >& coverageSubgradient, vector<double>& totalSubgradient);
+
+   //shortest path in the rotation network of the nurse for the current multipliers:
+   //store the worked shifts of the path (day -> shift) and return its cost
+   double solveNurse(LiveNurse* pNurse, double workDual, double weekendDual, map<int,int>& shifts);
+
+   //best rotation of the nurse for each first and last day (index in rotations, -1 if none)
+   vector< vector<int> > bestRotations(LiveNurse* pNurse, vector< vector<double> >& workDualCosts, double weekendDual,
+      vector<Rotation>& rotations);
+
+   //subgradient iterations from the current multipliers
+   double subgradient();
+};
+
+#endif /* SRC_LAGRANGIANSOLVER_H_ */
@@ -7,6 +7,7 @@
 
 #include "MasterProblem.h"
 #include "BcpModeler.h"
+#include "ClpModeler.h"
 //#include "CbcModeler.h"
 //#include "ScipModeler.h"
 #include "RotationPricer.h"
@@ -236,6 +237,28 @@ bool Rotation::compareDualCost(const Rotation& rot1, const Rotation& rot2){
    return ( rot1.dualCost_ < rot2.dualCost_ );
 }
 
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   R o t a t i o n P o o l
+//
+//-----------------------------------------------------------------------------
+
+void RotationPool::add(int contractId, const vector< map<int,int> >& rotations){
+   lock_guard<mutex> lock(mutex_);
+   set< map<int,int> >& contractRotations = rotations_[contractId];
+   for(const map<int,int>& shifts: rotations){
+      if(contractRotations.size() >= maxSize_)
+         break;
+      contractRotations.insert(shifts);
+   }
+}
+
+vector< map<int,int> > RotationPool::get(int contractId){
+   lock_guard<mutex> lock(mutex_);
+   set< map<int,int> >& contractRotations = rotations_[contractId];
+   return vector< map<int,int> >(contractRotations.begin(), contractRotations.end());
+}
+
 //-----------------------------------------------------------------------------
 //
 //  C l a s s   M a s t e r P r o b l e m
@@ -249,11 +272,11 @@ MasterProblem::MasterProblem(Scenario* pScenario, Demand* pDemand,
    Preferences* pPreferences, vector<State>* pInitState, MySolverType solverType):
 
    Solver(pScenario, pDemand, pPreferences, pInitState), PrintSolution(),
-   solverType_(solverType), pModel_(0), pPricer_(0), pRule_(0),
+   solverType_(solverType), pModel_(0), pPricer_(0), pRule_(0), coldRootLpIterations_(0), coldRootLpTime_(0),
    positionsPerSkill_(pScenario->nbSkills_), skillsPerPosition_(pScenario->nbPositions()),
-   rotations_(pScenario->nbNurses_), restsPerDay_(pScenario->nbNurses_),
+   rotations_(pScenario->nbNurses_), pRotationPool_(0), restsPerDay_(pScenario->nbNurses_),
 
-   columnVars_(pScenario->nbNurses_), restingVars_(pScenario->nbNurses_), longRestingVars_(pScenario->nbNurses_),
+   columnVars_(pScenario->nbNurses_), restingVars_(pScenario->nbNurses_), longRestingVars_(pScenario->nbNurses_), lazyLongRests_(false), longRestColumns_(pScenario->nbNurses_),
    minWorkedDaysVars_(pScenario->nbNurses_), maxWorkedDaysVars_(pScenario->nbNurses_), maxWorkedWeekendVars_(pScenario->nbNurses_),
    minWorkedDaysAvgVars_(pScenario->nbNurses_), maxWorkedDaysAvgVars_(pScenario->nbNurses_), maxWorkedWeekendAvgVars_(pScenario_->nbNurses_),
    minWorkedDaysContractAvgVars_(pScenario->nbContracts_), maxWorkedDaysContractAvgVars_(pScenario->nbContracts_), maxWorkedWeekendContractAvgVars_(pScenario_->nbContracts_),
@@ -287,6 +310,9 @@ void MasterProblem::initializeSolver(MySolverType solverType) {
       break;
    case S_CBC:
       pModel_ = new BcpModeler(PB_NAME);
+      break;
+   case S_CLP:
+      pModel_ = new ClpModeler(PB_NAME);
    }
 
    this->preprocessData();
@@ -328,6 +354,9 @@ void MasterProblem::initializeSolver(MySolverType solverType) {
 
 //build the rostering problem
 void MasterProblem::build(){
+   /* Blocks of identical nurses */
+   aggregateNurses();
+
    /* Rotation constraints */
    buildRotationCons();
 
@@ -351,6 +380,67 @@ void MasterProblem::build(){
    }
 }
 
+//a block of identical nurses has one rotation network carrying a flow equal to its number of nurses,
+//and its min/max constraints bound the totals of the block: they are the sum of the ones of its nurses.
+//The penalties of the block would only be a lower bound of the sum of the penalties of its nurses,
+//so only the nurses whose totals cannot be penalized are aggregated: the master then stays exact
+void MasterProblem::aggregateNurses(){
+   representatives_.resize(pScenario_->nbNurses_);
+   for(int i=0; i<pScenario_->nbNurses_; ++i){
+      representatives_[i] = i;
+      theLiveNurses_[i]->multiplicity_ = 1;
+      if(!pModel_->getParameters().aggregateNurses_ || !hasLooseTotals(i))
+         continue;
+      for(int j=0; j<i; ++j)
+         if(representatives_[j] == j && areIdenticalNurses(j, i)){
+            representatives_[i] = j;
+            theLiveNurses_[i]->multiplicity_ = 0;
+            ++theLiveNurses_[j]->multiplicity_;
+            break;
+         }
+   }
+}
+
+bool MasterProblem::areIdenticalNurses(int i, int j){
+   LiveNurse *pNurse1 = theLiveNurses_[i], *pNurse2 = theLiveNurses_[j];
+   if(pNurse1->pContract_ != pNurse2->pContract_ || pNurse1->pPosition_ != pNurse2->pPosition_)
+      return false;
+
+   State *pState1 = pNurse1->pStateIni_, *pState2 = pNurse2->pStateIni_;
+   if(pState1->totalDaysWorked_ != pState2->totalDaysWorked_ || pState1->totalWeekendsWorked_ != pState2->totalWeekendsWorked_
+      || pState1->consDaysWorked_ != pState2->consDaysWorked_ || pState1->consShifts_ != pState2->consShifts_
+      || pState1->consDaysOff_ != pState2->consDaysOff_ || pState1->shift_ != pState2->shift_)
+      return false;
+
+   if(*pNurse1->pWishesOff_ != *pNurse2->pWishesOff_)
+      return false;
+
+   //the bounds computed by the solver (the averaged ones may be empty)
+   for(vector<double>* pBounds: {&minTotalShifts_, &maxTotalShifts_, &maxTotalWeekends_,
+      &minTotalShiftsAvg_, &maxTotalShiftsAvg_, &weightTotalShiftsAvg_, &maxTotalWeekendsAvg_, &weightTotalWeekendsAvg_,
+      &weightTotalShiftsMin_, &weightTotalShiftsMax_, &weightTotalWeekendsMax_})
+      if(!pBounds->empty() && (*pBounds)[i] != (*pBounds)[j])
+         return false;
+
+   return true;
+}
+
+bool MasterProblem::hasLooseTotals(int i){
+   const int nbDays = pDemand_->nbDays_, nbWeekends = Tools::containsWeekend(0, nbDays-1);
+   if(minTotalShifts_[i] > 0 || maxTotalShifts_[i] < nbDays || maxTotalWeekends_[i] < nbWeekends)
+      return false;
+
+   //the bounds averaged over the weeks (they may be empty)
+   if(!minTotalShiftsAvg_.empty() && !maxTotalShiftsAvg_.empty() && !weightTotalShiftsAvg_.empty()
+      && (minTotalShiftsAvg_[i] > 0 || maxTotalShiftsAvg_[i] < nbDays))
+      return false;
+   if(!maxTotalWeekendsAvg_.empty() && !weightTotalWeekendsAvg_.empty()
+      && maxTotalWeekendsAvg_[i] - theLiveNurses_[i]->pStateIni_->totalWeekendsWorked_ < nbWeekends)
+      return false;
+
+   return true;
+}
+
 //solve the rostering problem
 double MasterProblem::solve(vector<Roster> solution){
    return solve(solution, true);
@@ -374,7 +464,13 @@ double MasterProblem::solve(vector<Roster> solution, bool rebuild){
       pModel_->reset();
 
    // input an initial solution
-   initialize(solution);
+   // on a resolve, all the columns of the previous solves are kept (feasibility columns included)
+   if(rebuild || solution.size() > 0)
+      initialize(solution);
+
+   // seed the rotations found by the master problems of the same demand
+   if(pRotationPool_)
+      addPoolRotations();
 
    pModel_->writeProblem("outfiles/model.lp");
 
@@ -386,6 +482,14 @@ double MasterProblem::solve(vector<Roster> solution, bool rebuild){
    solveWithCatch();
    pModel_->printStats();
 
+   if(pRotationPool_)
+      storePoolRotations();
+
+   if(rebuild){
+      coldRootLpIterations_ = pModel_->getRootLpIterations();
+      coldRootLpTime_ = pModel_->getRootLpTime();
+   }
+
    if(!pModel_->printBestSol())
 	   return pModel_->getRelaxedObjective();
 
@@ -413,7 +517,16 @@ double MasterProblem::resolve(Demand* pDemand, SolverParam parameters, vector<Ro
    updateDemand(pDemand);
    parameters.saveFunction_ = this;
    pModel_->setParameters(parameters);
-   return solve(solution, false);
+   double objValue = solve(solution, false);
+
+   //display the savings of the warm start on the root node compared to the first solve
+   FILE * pFile;
+   pFile = pModel_->logfile().empty() ? stdout : fopen (pModel_->logfile().c_str(),"a");
+   fprintf(pFile,"%-30s %8d simplex iterations in %6.2fs (first solve: %8d in %6.2fs)\n", "Warm-started root:",
+      pModel_->getRootLpIterations(), pModel_->getRootLpTime(), coldRootLpIterations_, coldRootLpTime_);
+   if (!pModel_->logfile().empty()) fclose(pFile);
+
+   return objValue;
 }
 
 //initialize the rostering problem with one column to be feasible if there is no initial solution
@@ -429,6 +542,9 @@ void MasterProblem::initialize(vector<Roster> solution){
          shifts.insert(pair<int,int>( k , -1 ));
 
       for(int i=0; i<pScenario_->nbNurses_; ++i){
+         //the block of an aggregated nurse already has a column
+         if(theLiveNurses_[i]->multiplicity_ == 0)
+            continue;
          Rotation rotation(shifts, theLiveNurses_[i], LARGE_SCORE);
          addRotation(rotation, baseName);
       }
@@ -439,6 +555,8 @@ void MasterProblem::initialize(vector<Roster> solution){
       for(int i=0; i<pScenario_->nbNurses_; ++i){
          //load the roster of nurse i
          Roster roster = solution[i];
+         //its rotations belong to the network of the nurse representing it
+         LiveNurse* pNurse = theLiveNurses_[representatives_[i]];
 
          bool workedLastDay = false;
          int lastShift = 0;
@@ -459,17 +577,28 @@ void MasterProblem::initialize(vector<Roster> solution){
             }
             //if stop to work, build the rotation
             else if(workedLastDay){
-               Rotation rotation(shifts, theLiveNurses_[i]);
+               Rotation rotation(shifts, pNurse);
                rotation.computeCost(pScenario_, pPreferences_, pDemand_->nbDays_);
                addRotation(rotation, baseName);
                shifts.clear();
                lastShift = shift;
                workedLastDay = false;
+
+               //the long resting arc following the rotation may not have been generated yet
+               if(lazyLongRests_){
+                  int nbDaysOff = 1;
+                  while(k+nbDaysOff < pDemand_->nbDays_ && roster.shift(k+nbDaysOff) <= 0)
+                     ++nbDaysOff;
+                  //the other nurses of a block may have already added it
+                  const int l = min(nbDaysOff, nbLongRestingArcs_[pNurse->id_]);
+                  if(!longRestColumns_[pNurse->id_].count(pair<int,int>(k, l)))
+                     addLongRest(pNurse->id_, k, l, 0);
+               }
             }
          }
          //if work on the last day, build the rotation
          if(workedLastDay){
-            Rotation rotation(shifts, theLiveNurses_[i]);
+            Rotation rotation(shifts, pNurse);
             rotation.computeCost(pScenario_, pPreferences_, pDemand_->nbDays_);
             addRotation(rotation, baseName);
             shifts.clear();
@@ -496,26 +625,77 @@ void MasterProblem::storeSolution(){
       skillsAllocation[k] = skillsAllocation2;
    }
 
+   //share out the rotations of the solution among the nurses: the integer flow of the rotation network of each block
+   //of identical nurses is decomposed into one path per nurse
+   //the nodes are the resting nodes k in [0, nbDays-1] (0 is the source) and then the working nodes k in [1, nbDays] (nbDays is the sink)
+   const int nbDays = pDemand_->nbDays_;
+   auto restNode = [](int k) { return k; };
+   auto workNode = [nbDays](int k) { return nbDays + k - 1; };
+   vector< vector<Rotation*> > nurseRotations(pScenario_->nbNurses_);
+   for(int i=0; i<pScenario_->nbNurses_; ++i){
+      if(representatives_[i] != i)
+         continue;
+      vector<int> block;
+      for(int j=i; j<pScenario_->nbNurses_; ++j)
+         if(representatives_[j] == i)
+            block.push_back(j);
+
+      vector<RotationFlowArc> arcs;
+      //rotations: from the source or the working node of their first day, to the resting node of the day after their last day or the sink
+      //(the resting arcs from the initial state are stored with an empty rotation)
+      for(pair<MyVar* const, Rotation>& p: rotations_[i]){
+         Rotation& rot = p.second;
+         const int flow = round(pModel_->getVarValue(p.first));
+         if(flow == 0 || rot.length_ == 0)
+            continue;
+         const int lastDay = rot.firstDay_ + rot.length_ - 1;
+         arcs.push_back(RotationFlowArc((rot.firstDay_ == 0) ? restNode(0) : workNode(rot.firstDay_),
+            (lastDay == nbDays-1) ? workNode(nbDays) : restNode(lastDay+1), flow, &rot));
+      }
+      //resting arcs: the short ones go from the working node of their day, the long ones from the resting node of their first day,
+      //and all of them go to the working node of the day after their last day
+      map<MyVar*, pair<int,int> > restDays;
+      for(int k=0; k<nbDays; ++k)
+         for(MyVar* var: restsPerDay_[i][k]){
+            map<MyVar*, pair<int,int> >::iterator it = restDays.find(var);
+            if(it == restDays.end())
+               restDays[var] = pair<int,int>(k, k);
+            else
+               it->second.second = k;
+         }
+      set<MyVar*> shortRests(restingVars_[i].begin(), restingVars_[i].end());
+      for(pair<MyVar* const, pair<int,int> >& p: restDays){
+         const int flow = round(pModel_->getVarValue(p.first));
+         if(flow == 0)
+            continue;
+         arcs.push_back(RotationFlowArc(shortRests.count(p.first) ? workNode(p.second.first) : restNode(p.second.first),
+            workNode(p.second.second+1), flow));
+      }
+
+      vector< vector<Rotation*> > paths = decomposeRotationFlow(arcs, restNode(0), workNode(nbDays), block.size());
+      for(int n=0; n<block.size(); ++n)
+         nurseRotations[block[n]] = paths[n];
+   }
+
    //build the rosters
    for(LiveNurse* pNurse: theLiveNurses_){
       pNurse->roster_.reset();
-      for(pair<MyVar*, Rotation> p: rotations_[pNurse->id_])
-         if(pModel_->getVarValue(p.first) > EPSILON)
-            for(int k=p.second.firstDay_; k<p.second.firstDay_+p.second.length_; ++k){
-               bool assigned = false;
-               for(int sk=0; sk<pScenario_->nbSkills_; ++sk)
-                  if(skillsAllocation[k][p.second.shifts_[k]-1][sk][pNurse->pPosition_->id_] > EPSILON){
-                     pNurse->roster_.assignTask(k,p.second.shifts_[k],sk);
-                     skillsAllocation[k][p.second.shifts_[k]-1][sk][pNurse->pPosition_->id_] --;
-                     assigned = true;
-                     break;
-                  }
-               if(!assigned){
-                  char error[255];
-                  sprintf(error, "No skill found for Nurse %d on day %d on shift %d", pNurse->id_, k, p.second.shifts_[k]);
-                  Tools::throwError((const char*) error);
+      for(Rotation* pRot: nurseRotations[pNurse->id_])
+         for(int k=pRot->firstDay_; k<pRot->firstDay_+pRot->length_; ++k){
+            bool assigned = false;
+            for(int sk=0; sk<pScenario_->nbSkills_; ++sk)
+               if(skillsAllocation[k][pRot->shifts_[k]-1][sk][pNurse->pPosition_->id_] > EPSILON){
+                  pNurse->roster_.assignTask(k,pRot->shifts_[k],sk);
+                  skillsAllocation[k][pRot->shifts_[k]-1][sk][pNurse->pPosition_->id_] --;
+                  assigned = true;
+                  break;
                }
+            if(!assigned){
+               char error[255];
+               sprintf(error, "No skill found for Nurse %d on day %d on shift %d", pNurse->id_, k, pRot->shifts_[k]);
+               Tools::throwError((const char*) error);
             }
+         }
    }
 
    //build the states of each nurse
@@ -526,6 +706,29 @@ void MasterProblem::storeSolution(){
    }
 }
 
+//decompose the integer flow of the arcs from the source to the sink into nbPaths paths
+//the network is acyclic, as each arc goes forward in time: any arc with a remaining flow can extend a path
+vector< vector<Rotation*> > MasterProblem::decomposeRotationFlow(vector<RotationFlowArc> arcs, int source, int sink, int nbPaths){
+   vector< vector<Rotation*> > paths(nbPaths);
+   for(int n=0; n<nbPaths; ++n){
+      int node = source;
+      while(node != sink){
+         vector<RotationFlowArc>::iterator it = find_if(arcs.begin(), arcs.end(),
+            [node](RotationFlowArc& arc) { return arc.tail_ == node && arc.flow_ > 0; });
+         if(it == arcs.end()){
+            char error[255];
+            sprintf(error, "The flow of the rotation network cannot be decomposed: no flow out of node %d for the path %d", node, n);
+            Tools::throwError((const char*) error);
+         }
+         --it->flow_;
+         if(it->pRotation_)
+            paths[n].push_back(it->pRotation_);
+         node = it->head_;
+      }
+   }
+   return paths;
+}
+
 void MasterProblem::save(vector<int>& weekIndices, string outdir){
    storeSolution();
 
@@ -543,6 +746,48 @@ void MasterProblem::save(vector<int>& weekIndices, string outdir){
    }
 }
 
+//add the rotations of the pool which are not in the master yet
+//the pool rotations of a contract are valid for all its nurses, as none of them starts on the first day
+void MasterProblem::addPoolRotations(){
+   char* baseName = "poolRotation";
+   vector<Rotation> rotations;
+   for(int i=0; i<pScenario_->nbNurses_; ++i){
+      LiveNurse* pNurse = theLiveNurses_[i];
+      //the block of an aggregated nurse has the rotations of its representative
+      if(pNurse->multiplicity_ == 0)
+         continue;
+
+      set< map<int,int> > existingRotations;
+      for(pair<MyVar* const, Rotation>& p: rotations_[i])
+         existingRotations.insert(p.second.shifts_);
+
+      for(map<int,int>& shifts: pRotationPool_->get(pNurse->pContract_->id_)){
+         if(existingRotations.count(shifts))
+            continue;
+         Rotation rotation(shifts, pNurse);
+         rotation.computeCost(pScenario_, pPreferences_, pDemand_->nbDays_);
+         rotations.push_back(rotation);
+      }
+   }
+   addRotations(rotations, baseName);
+}
+
+//add to the pool the rotations of the master which do not start on the first day
+//(the resting arcs and the artificial columns of the initialization are not rotations)
+void MasterProblem::storePoolRotations(){
+   map<int, vector< map<int,int> > > rotationsPerContract;
+   for(int i=0; i<pScenario_->nbNurses_; ++i)
+      for(pair<MyVar* const, Rotation>& p: rotations_[i]){
+         Rotation& rotation = p.second;
+         if(rotation.shifts_.empty() || rotation.firstDay_ == 0 || rotation.shifts_.begin()->second < 0)
+            continue;
+         rotationsPerContract[theLiveNurses_[i]->pContract_->id_].push_back(rotation.shifts_);
+      }
+
+   for(pair<const int, vector< map<int,int> > >& p: rotationsPerContract)
+      pRotationPool_->add(p.first, p.second);
+}
+
 //build the variable of the rotation as well as all the affected constraints with their coefficients
 //if s=-1, the nurse i works on all shifts
 void MasterProblem::addRotation(Rotation& rotation, char* baseName){
@@ -555,6 +800,65 @@ void MasterProblem::addRotation(Rotation& rotation, char* baseName){
 	vector<MyCons*> cons;
 	vector<double> coeffs;
 
+	addAllConsToCol(cons, coeffs, rotation);
+
+	//the name is only formatted if the model stores it
+	if(pModel_->isStoringNames())
+		sprintf(name, "%s_N%d_%d",baseName , i, rotations_[i].size());
+	pModel_->createIntColumn(&var, pModel_->isStoringNames() ? name : 0, rotation.cost_, rotation.dualCost_, cons, coeffs);
+	rotations_[i].insert(pair<MyVar*,Rotation>(var, rotation));
+}
+
+//build the variables of a set of rotations at once
+void MasterProblem::addRotations(vector<Rotation>& rotations, char* baseName){
+	const int nbRotations = rotations.size();
+	if(nbRotations == 0)
+		return;
+
+	//Column vars, their names, costs, and affected constraints with their coefficients
+	//the coefficients of the column r are in [starts[r], starts[r+1]) of cons and coeffs
+	vector<MyVar*> vars;
+	//names stays empty if the model does not store them
+	vector<string> names;
+	if(pModel_->isStoringNames())
+		names.resize(nbRotations);
+	vector<double> costs(nbRotations), dualCosts(nbRotations);
+	vector<int> starts(nbRotations+1);
+	vector<MyCons*> cons;
+	vector<double> coeffs;
+	char name[255];
+
+	//number of rotations already named for each nurse
+	vector<int> nbRotationsNamed(pScenario_->nbNurses_, -1);
+	for(int r=0; r<nbRotations; ++r){
+		Rotation& rotation = rotations[r];
+		int i = rotation.pNurse_->id_;
+		if(nbRotationsNamed[i] < 0)
+			nbRotationsNamed[i] = rotations_[i].size();
+
+		starts[r] = cons.size();
+		addAllConsToCol(cons, coeffs, rotation);
+
+		if(!names.empty()){
+			sprintf(name, "%s_N%d_%d",baseName , i, nbRotationsNamed[i]++);
+			names[r] = name;
+		}
+		costs[r] = rotation.cost_;
+		dualCosts[r] = rotation.dualCost_;
+	}
+	starts[nbRotations] = cons.size();
+
+	pModel_->createColumns(vars, VARTYPE_INTEGER, names, costs, dualCosts, starts, cons, coeffs);
+
+	for(int r=0; r<nbRotations; ++r)
+		rotations_[rotations[r].pNurse_->id_].insert(pair<MyVar*,Rotation>(vars[r], rotations[r]));
+}
+
+//add the constraints and coefficients of all the constraints affected by a rotation
+void MasterProblem::addAllConsToCol(vector<MyCons*>& cons, vector<double>& coeffs, Rotation& rotation){
+	//nurse index
+	int i = rotation.pNurse_->id_;
+
 	/* Rotation constraints */
 	addRotationConsToCol(cons, coeffs, i, rotation.firstDay_, true, false);
 	addRotationConsToCol(cons, coeffs, i, rotation.firstDay_+rotation.length_-1, false, true);
@@ -566,10 +870,6 @@ void MasterProblem::addRotation(Rotation& rotation, char* baseName){
 	/* Skills coverage constraints */
 	for(int k=rotation.firstDay_; k<rotation.firstDay_+rotation.length_; ++k)
 		addSkillsCoverageConsToCol(cons, coeffs, i, k, rotation.shifts_[k]);
-
-	sprintf(name, "%s_N%d_%d",baseName , i, rotations_[i].size());
-	pModel_->createIntColumn(&var, name, rotation.cost_, rotation.dualCost_, cons, coeffs);
-	rotations_[i].insert(pair<MyVar*,Rotation>(var, rotation));
 }
 
 /*
@@ -577,8 +877,16 @@ void MasterProblem::addRotation(Rotation& rotation, char* baseName){
  */
 void MasterProblem::buildRotationCons(){
    char name[255];
+   //the long resting arcs which do not start from the initial state are priced by the pricer when there is one
+   lazyLongRests_ = (solverType_ != S_CBC) && pModel_->getParameters().lazyLongRests_;
+   nbLongRestingArcs_.resize(pScenario_->nbNurses_);
+
    //build the rotation network for each nurse
    for(int i=0; i<pScenario_->nbNurses_; i++){
+      //a block of identical nurses has only the network of its representative
+      const int multiplicity = theLiveNurses_[i]->multiplicity_;
+      if(multiplicity == 0)
+         continue;
       int minConsDaysOff(theLiveNurses_[i]->minConsDaysOff()),
          maxConsDaysOff(theLiveNurses_[i]->maxConsDaysOff()),
          initConsDaysOff(theLiveNurses_[i]->pStateIni_->consDaysOff_);
@@ -587,6 +895,7 @@ void MasterProblem::buildRotationCons(){
       bool const maxRest = (maxConsDaysOff < pDemand_->nbDays_ + initConsDaysOff);
       //number of long resting arcs as function of maxRest
       int const nbLongRestingArcs((maxRest) ? maxConsDaysOff : minConsDaysOff);
+      nbLongRestingArcs_[i] = nbLongRestingArcs;
       //first day when a rest arc exists =
       //nbLongRestingArcs - number of consecutive worked days in the past
       int const firstRestArc( min( max( 0, nbLongRestingArcs - initConsDaysOff ), pDemand_->nbDays_-1 ) );
@@ -658,7 +967,8 @@ void MasterProblem::buildRotationCons(){
          /*****************************************
           * long resting arcs without the first ones
           *****************************************/
-         else{
+         //if lazy, they are generated on demand by the pricer
+         else if(!lazyLongRests_){
             //number of long resting arcs = min(nbLongRestingArcs, number of possible long resting arcs)
             int nbLongRestingArcs2( min(nbLongRestingArcs, pDemand_->nbDays_-k) );
             //initialize cost
@@ -722,8 +1032,8 @@ void MasterProblem::buildRotationCons(){
          for(int l=0; l<longRestingVars2[k].size(); ++l)
             coeffs[l] = 1;
          sprintf(name, "restingNodes_N%d_%d", i, k);
-         //Create flow constraints. out flow = 1 if source node (k=0)
-         pModel_->createEQConsLinear(&restFlowCons2[k], name, (k==0) ? 1 : 0,
+         //Create flow constraints. out flow = number of nurses of the block if source node (k=0)
+         pModel_->createEQConsLinear(&restFlowCons2[k], name, (k==0) ? multiplicity : 0,
             longRestingVars2[k], coeffs);
       }
 
@@ -739,9 +1049,9 @@ void MasterProblem::buildRotationCons(){
          //add long resting arcs
          for(int l=0; l<nbLongRestingArcs2; ++l){
             //if the long resting arc starts on the source node,
-            //check if there exists such an arc
+            //check if there exists such an arc (the lazy ones do not exist yet)
             if( (l > k-1) || (l >= longRestingVars2[k-1-l].size()) )
-               break;
+               continue;
             vars.push_back(longRestingVars2[k-1-l][l]);
             //compute in-flow for the sink
             if(k==pDemand_->nbDays_)
@@ -772,8 +1082,8 @@ void MasterProblem::buildRotationCons(){
             coeffs.push_back(1);
          }
          sprintf(name, "workingNodes_N%d_%d", i, k);
-         //Create flow constraints. in flow = 1 if sink node (k==pDemand_->nbDays_)
-         pModel_->createEQConsLinear(&workFlowCons2[k-1], name, (k==pDemand_->nbDays_) ? 1 : 0,
+         //Create flow constraints. in flow = number of nurses of the block if sink node (k==pDemand_->nbDays_)
+         pModel_->createEQConsLinear(&workFlowCons2[k-1], name, (k==pDemand_->nbDays_) ? multiplicity : 0,
             vars, coeffs);
       }
 
@@ -783,6 +1093,13 @@ void MasterProblem::buildRotationCons(){
       longRestingVars_[i] = longRestingVars2;
       restFlowCons_[i] = restFlowCons2;
       workFlowCons_[i] = workFlowCons2;
+
+      //the resting arcs carry an integer flow: they can be fixed by reduced cost
+      for(MyVar* var: restingVars2)
+         pModel_->addFixableCoreVar(var);
+      for(vector<MyVar*>& vars2: longRestingVars2)
+         for(MyVar* var: vars2)
+            if(var) pModel_->addFixableCoreVar(var);
    }
 }
 
@@ -822,6 +1139,35 @@ int MasterProblem::addRotationConsToCol(vector<MyCons*>& cons, vector<double>& c
    return 0;
 }
 
+//cost of the long resting arc of the nurse i starting on day k>0 and of length l
+//if the arc finishes the last day, the cost is 0. Indeed it will be computed on the next planning
+double MasterProblem::getLongRestCost(int i, int k, int l){
+   const int minConsDaysOff = theLiveNurses_[i]->minConsDaysOff();
+   if(l >= pDemand_->nbDays_-k || l > minConsDaysOff)
+      return 0;
+   return (minConsDaysOff - l) * WEIGHT_CONS_DAYS_OFF;
+}
+
+//create the column of the long resting arc of the nurse i starting on day k>0 and of length l
+void MasterProblem::addLongRest(int i, int k, int l, double dualCost){
+   MyVar* var;
+   char name[255];
+   //out-flow of the resting node k, in-flow of the working node k+l (or of the sink)
+   vector<MyCons*> cons = {restFlowCons_[i][k], workFlowCons_[i][k+l-1]};
+   vector<double> coeffs = {1.0, (k+l == pDemand_->nbDays_) ? 1.0 : -1.0};
+
+   //the name is only formatted if the model stores it
+   if(pModel_->isStoringNames())
+      sprintf(name, "longRestingVars_N%d_%d_%d", i, k, k+l);
+   pModel_->createPositiveColumn(&var, pModel_->isStoringNames() ? name : 0, getLongRestCost(i, k, l), dualCost, cons, coeffs);
+
+   longRestingVars_[i][k].push_back(var);
+   longRestColumns_[i].insert(pair<int,int>(k, l));
+   //add this resting arc for each day of rest
+   for(int k1=k; k1<k+l; ++k1)
+      restsPerDay_[i][k1].push_back(var);
+}
+
 /*
  * Min/Max constraints
  */
@@ -829,6 +1175,10 @@ void MasterProblem::buildMinMaxCons(){
    char name[255];
    for(int i=0; i<pScenario_->nbNurses_; i++){
       LiveNurse* pNurse = theLiveNurses_[i];
+      //the constraints of a block of identical nurses bound the totals of the block
+      const int multiplicity = pNurse->multiplicity_;
+      if(multiplicity == 0)
+         continue;
 
       sprintf(name, "minWorkedDaysVar_N%d", i);
       pModel_->createPositiveVar(&minWorkedDaysVars_[i], name, weightTotalShiftsMin_[i]);
@@ -838,12 +1188,12 @@ void MasterProblem::buildMinMaxCons(){
       sprintf(name, "minWorkedDaysCons_N%d", i);
       vector<MyVar*> vars1 = {minWorkedDaysVars_[i]};
       vector<double> coeffs1 = {1};
-      pModel_->createGEConsLinear(&minWorkedDaysCons_[i], name, minTotalShifts_[i], vars1, coeffs1);
+      pModel_->createGEConsLinear(&minWorkedDaysCons_[i], name, multiplicity*minTotalShifts_[i], vars1, coeffs1);
 
       sprintf(name, "maxWorkedDaysCons_N%d", i);
       vector<MyVar*> vars2 = {maxWorkedDaysVars_[i]};
       vector<double> coeffs2 = {-1};
-      pModel_->createLEConsLinear(&maxWorkedDaysCons_[i], name, maxTotalShifts_[i], vars2, coeffs2);
+      pModel_->createLEConsLinear(&maxWorkedDaysCons_[i], name, multiplicity*maxTotalShifts_[i], vars2, coeffs2);
 
       // add constraints on the total number of shifts to satisfy bounds that
       // correspond to the global bounds averaged over the weeks
@@ -858,7 +1208,7 @@ void MasterProblem::buildMinMaxCons(){
           sprintf(name, "minWorkedDaysAvgCons_N%d", i);
           vector<MyVar*> varsAvg1 = {minWorkedDaysVars_[i], minWorkedDaysAvgVars_[i]};
           vector<double> coeffsAvg1 = {1,1};
-          pModel_->createGEConsLinear(&minWorkedDaysAvgCons_[i], name, minTotalShiftsAvg_[i], varsAvg1, coeffsAvg1);
+          pModel_->createGEConsLinear(&minWorkedDaysAvgCons_[i], name, multiplicity*minTotalShiftsAvg_[i], varsAvg1, coeffsAvg1);
 
           isMinWorkedDaysAvgCons_[i] = true;
         }
@@ -870,7 +1220,7 @@ void MasterProblem::buildMinMaxCons(){
   	      sprintf(name, "maxWorkedDaysAvgCons_N%d", i);
   	      vector<MyVar*> varsAvg2 = {maxWorkedDaysVars_[i],maxWorkedDaysAvgVars_[i]};
   	      vector<double> coeffsAvg2 = {-1,-1};
-  	      pModel_->createLEConsLinear(&maxWorkedDaysAvgCons_[i], name, maxTotalShiftsAvg_[i], varsAvg2, coeffsAvg2);
+  	      pModel_->createLEConsLinear(&maxWorkedDaysAvgCons_[i], name, multiplicity*maxTotalShiftsAvg_[i], varsAvg2, coeffsAvg2);
 
           isMaxWorkedDaysAvgCons_[i] = true;
         }
@@ -882,7 +1232,7 @@ void MasterProblem::buildMinMaxCons(){
       sprintf(name, "maxWorkedWeekendCons_N%d", i);
       vector<MyVar*> vars3 = {maxWorkedWeekendVars_[i]};
       vector<double> coeffs3 = {-1};
-      pModel_->createLEConsLinear(&maxWorkedWeekendCons_[i], name, maxTotalWeekends_[i],
+      pModel_->createLEConsLinear(&maxWorkedWeekendCons_[i], name, multiplicity*maxTotalWeekends_[i],
          vars3, coeffs3);
 
       if ( !maxTotalWeekendsAvg_.empty()  && !weightTotalWeekendsAvg_.empty()
@@ -894,7 +1244,7 @@ void MasterProblem::buildMinMaxCons(){
       	sprintf(name, "maxWorkedWeekendAvgCons_N%d", i);
 	      vector<MyVar*> varsAvg3 = {maxWorkedWeekendVars_[i],maxWorkedWeekendAvgVars_[i]};
 	      vector<double> coeffsAvg3 = {-1,-1};
-	      pModel_->createLEConsLinear(&maxWorkedWeekendAvgCons_[i], name, maxTotalWeekendsAvg_[i]- theLiveNurses_[i]->pStateIni_->totalWeekendsWorked_,
+	      pModel_->createLEConsLinear(&maxWorkedWeekendAvgCons_[i], name, multiplicity*(maxTotalWeekendsAvg_[i]- theLiveNurses_[i]->pStateIni_->totalWeekendsWorked_),
           varsAvg3, coeffsAvg3);
 
         isMaxWorkedWeekendAvgCons_[i] = true;
@@ -18,6 +18,9 @@
 #include "Nurse.h"
 #include "Modeler.h"
 
+#include <atomic>
+#include <mutex>
+
 //-----------------------------------------------------------------------------
 //
 //  S t r u c t   R o t a t i o n
@@ -74,22 +77,20 @@ struct Rotation {
    // Specific constructors and destructors
    //
    Rotation(map<int,int> shifts, LiveNurse* nurse = NULL, double cost = DBL_MAX, double dualCost = DBL_MAX) :
-      shifts_(shifts), pNurse_(nurse), cost_(cost),id_(s_count),
+      shifts_(shifts), pNurse_(nurse), cost_(cost),id_(s_count++),
       consShiftsCost_(0), consDaysWorkedCost_(0), completeWeekendCost_(0), preferenceCost_(0), initRestCost_(0),
       dualCost_(dualCost), length_(shifts.size())
    {
-      ++s_count;
       firstDay_ = 999;
       for(map<int,int>::iterator itS = shifts.begin(); itS != shifts.end(); ++itS)
          if(itS->first < firstDay_) firstDay_ = itS->first;
    };
 
    Rotation(int firstDay, vector<int> shiftSuccession, LiveNurse* nurse = NULL, double cost = DBL_MAX, double dualCost = DBL_MAX) :
-      pNurse_(nurse), cost_(cost),id_(s_count),
+      pNurse_(nurse), cost_(cost),id_(s_count++),
       consShiftsCost_(0), consDaysWorkedCost_(0), completeWeekendCost_(0), preferenceCost_(0), initRestCost_(0),
       dualCost_(dualCost), firstDay_(firstDay), length_(shiftSuccession.size())
    {
-      ++s_count;
       for(int k=0; k<shiftSuccession.size(); k++) shifts_.insert(pair<int,int>( (firstDay+k) , shiftSuccession[k] ));
    }
 
@@ -108,8 +109,9 @@ struct Rotation {
    ~Rotation(){};
 
    //count rotations
+   //atomic as the rotations are created by the sub problems of several solving threads
    //
-   static unsigned int s_count;
+   static atomic<unsigned int> s_count;
 
    //Id of the rotation
    //
@@ -175,6 +177,43 @@ struct Rotation {
    static bool compareDualCost(const Rotation& rot1, const Rotation& rot2);
 };
 
+//arc of the rotation network of a nurse (or of a block of identical nurses) with the integer flow of a solution:
+//a rotation, or a resting arc if pRotation_ is null
+struct RotationFlowArc {
+   RotationFlowArc(int tail, int head, int flow, Rotation* pRotation = 0):
+      tail_(tail), head_(head), flow_(flow), pRotation_(pRotation) { }
+
+   int tail_, head_, flow_;
+   Rotation* pRotation_;
+};
+
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   R o t a t i o n P o o l
+//
+//  Rotations shared by the master problems of the same demand with different
+//  initial states: the rotations that do not start on the first day do not
+//  depend on the initial states, so they are valid for all the nurses of the
+//  same contract. Thread-safe, as these master problems may be solved concurrently.
+//
+//-----------------------------------------------------------------------------
+class RotationPool{
+public:
+   RotationPool(int maxSize): maxSize_(maxSize) {}
+
+   //add the rotations (day -> shift) of a contract, until the pool has maxSize_ rotations for this contract
+   void add(int contractId, const vector< map<int,int> >& rotations);
+
+   //rotations of a contract
+   vector< map<int,int> > get(int contractId);
+
+protected:
+   std::mutex mutex_;
+   int maxSize_;
+   map<int, set< map<int,int> > > rotations_;
+};
+
 
 //-----------------------------------------------------------------------------
 //
@@ -184,7 +223,7 @@ struct Rotation {
 //
 //-----------------------------------------------------------------------------
 
-enum MySolverType { S_SCIP, S_BCP, S_CBC };
+enum MySolverType { S_SCIP, S_BCP, S_CBC, S_CLP };
 
 class MasterProblem : public Solver, public PrintSolution{
    //allows RotationPricer to access all private arguments and methods of MasterProblem
@@ -217,17 +256,46 @@ public:
    //override PrintSolution virtual method
    void save(vector<int>& weekIndices, string outdir);
 
+   //decompose the integer flow of the arcs from the source to the sink into nbPaths paths,
+   //and return the rotations of each path: each nurse of a block gets the rests of the solution between its rotations
+   static vector< vector<Rotation*> > decomposeRotationFlow(vector<RotationFlowArc> arcs, int source, int sink, int nbPaths);
+
 
    //get a reference to the rotations
    inline vector< map<MyVar*, Rotation> >& getRotations(){
       return rotations_;
    }
 
+   //share the rotations with the master problems of the same demand through the pool (0 if none):
+   //the master is seeded with the rotations of the pool, and its rotations are added to the pool after each solve
+   void setRotationPool(RotationPool* pRotationPool){
+      pRotationPool_ = pRotationPool;
+   }
+
    //get a reference to the restsPerDay_ for a Nurse
    inline vector< vector<MyVar*> >& getRestsPerDay(Nurse* pNurse){
       return restsPerDay_[pNurse->id_];
    }
 
+   //get all the variables counting the number of nurses by position (k,s,p)
+   inline vector<MyVar*> getNursesNumberVars(){
+      vector<MyVar*> vars;
+      for(vector< vector<MyVar*> >& vars2: numberOfNursesByPositionVars_)
+         for(vector<MyVar*>& vars1: vars2)
+            vars.insert(vars.end(), vars1.begin(), vars1.end());
+      return vars;
+   }
+
+   //get all the skill allocation variables (k,s,sk,p)
+   inline vector<MyVar*> getSkillsAllocVars(){
+      vector<MyVar*> vars;
+      for(vector< vector< vector<MyVar*> > >& vars3: skillsAllocVars_)
+         for(vector< vector<MyVar*> >& vars2: vars3)
+            for(vector<MyVar*>& vars1: vars2)
+               vars.insert(vars.end(), vars1.begin(), vars1.end());
+      return vars;
+   }
+
    /*
     * Solving parameterdoubles
     */
@@ -242,9 +310,19 @@ private:
    MyBranchingRule* pRule_; //choose the variables on which we should branch
    MySolverType solverType_; //which solver is used
 
+   //number of simplex iterations and time spent in the root node of the first solve (no warm start)
+   //used to measure the savings of the warm started resolves
+   int coldRootLpIterations_;
+   double coldRootLpTime_;
+
    vector< map<MyVar*, Rotation> > rotations_;//stores the variables and the rotations for each nurse
+   RotationPool* pRotationPool_; //pool of rotations shared with the master problems of the same demand
    vector< vector< vector<MyVar*> > > restsPerDay_; //stores all the arcs that are resting on a day for each nurse
 
+   //index of the nurse representing each nurse in the master problem (itself if the nurses are not aggregated)
+   //only the representatives have a rotation network and min/max constraints, for all the nurses of their block
+   vector<int> representatives_;
+
    /*
     * Variables
     */
@@ -252,6 +330,10 @@ private:
 
    vector< vector<MyVar*> > restingVars_; //binary variables for the resting arcs in the rotation network
    vector< vector< vector<MyVar*> > > longRestingVars_; //binary variables for the resting arcs in the rotation network
+   //if true, the long resting arcs which do not start on the first day are columns generated by the pricer
+   bool lazyLongRests_;
+   vector<int> nbLongRestingArcs_; //maximal length of the long resting arcs of each nurse
+   vector< set<pair<int,int> > > longRestColumns_; //(first day, length) of the long resting arcs generated as columns for each nurse
 
    vector<MyVar*> minWorkedDaysVars_; //count the number of missing worked days per nurse
    vector<MyVar*> maxWorkedDaysVars_; //count the number of exceeding worked days per nurse
@@ -315,9 +397,25 @@ private:
    // Main method to build the rostering problem for a given input
    void build();
 
+   //group the identical nurses in blocks represented by their first nurse (if aggregateNurses_)
+   void aggregateNurses();
+
+   //true if the nurses i and j are identical for the master problem:
+   //same contract, position, initial state, wishes and bounds on the total number of worked days/weekends
+   bool areIdenticalNurses(int i, int j);
+
+   //true if the bounds on the total number of worked days/weekends of the nurse i cannot be violated on the horizon
+   bool hasLooseTotals(int i);
+
    //Initialization of the rostering problem with/without solution
    void initialize(vector<Roster> solution);
 
+   //add the rotations of the pool which are not in the master yet
+   void addPoolRotations();
+
+   //add to the pool the rotations of the master which do not start on the first day
+   void storePoolRotations();
+
    //solve method to catch execption
    void solveWithCatch();
 
@@ -330,6 +428,13 @@ private:
    //store the rotation in rotations_
    void addRotation(Rotation& rotation, char* baseName);
 
+   //Create the variables of a set of rotations at once
+   //the coefficients of all the columns are given to the modeler in one flat buffer
+   void addRotations(vector<Rotation>& rotations, char* baseName);
+
+   //add the constraints and coefficients of all the constraints affected by a rotation
+   void addAllConsToCol(vector<MyCons*>& cons, vector<double>& coeffs, Rotation& rotation);
+
    //compute and add the last rotation finishing on the day just before the first one
    Rotation computeInitStateRotation(LiveNurse* pNurse);
 
@@ -343,6 +448,10 @@ private:
    /* Build each set of constraints - Add also the coefficient of a column for each set */
    void buildRotationCons();
    int addRotationConsToCol(vector<MyCons*>& cons, vector<double>& coeffs, int i, int k, bool firstDay, bool lastDay);
+
+   //long resting arcs of the nurse i starting on day k>0 and of length l: cost and creation of the column
+   double getLongRestCost(int i, int k, int l);
+   void addLongRest(int i, int k, int l, double dualCost);
    void buildMinMaxCons();
    int addMinMaxConsToCol(vector<MyCons*>& cons, vector<double>& coeffs, int i, int nbDays, int nbWeekends);
    void buildSkillsCoverageCons();
@@ -20,6 +20,7 @@
 #include <string>
 #include <cmath>
 #include <typeinfo>
+#include <atomic>
 #include "Solver.h"
 
 #include "MyTools.h"
@@ -43,26 +44,41 @@ enum SearchStrategy { BestFirstSearch, BreadthFirstSearch, DepthFirstSearch, Hig
  * If the object is added to the vector objects_ of the Modeler, the modeler will also delete it at the end.
  */
 struct MyObject {
-   MyObject(const char* name):id_(s_count) {
-      ++s_count;
-      char* name2 = new char[255];
-      strncpy(name2, name, 255);
-      name_ = name2;
-   }
-   MyObject(const MyObject& myObject):id_(myObject.id_) {
-      char* name2 = new char[255];
-      strncpy(name2, myObject.name_, 255);
-      name_ = name2;
-   }
+   //the name is only stored if one is given (see Modeler::storeNames_),
+   //otherwise it is generated on demand from the id
+   MyObject(const char* name):id_(s_count++), name_(copyName(name)) { }
+   MyObject(const MyObject& myObject):id_(myObject.id_), name_(copyName(myObject.name_)) { }
    virtual ~MyObject(){ delete[] name_; }
-   //count object
-   static unsigned int s_count;
+   //count object: atomic as several models can be built and solved in parallel
+   static atomic<unsigned int> s_count;
    //for the map rotations_
    int operator < (const MyObject& m) const { return this->id_ < m.id_; }
 
-   const char* name_;
+   //stored name if any, otherwise a name built from the id (for writeLP and debug printing)
+   string getName() const {
+      if(name_) return name_;
+      char name[32];
+      sprintf(name, "%s_%u", getNamePrefix(), id_);
+      return name;
+   }
+
+   bool hasName() const { return name_ != 0; }
+
+   unsigned int getId() const { return id_; }
+
+protected:
+   virtual const char* getNamePrefix() const { return "obj"; }
+
 private:
    const unsigned int id_;
+   const char* name_;
+
+   static const char* copyName(const char* name){
+      if(!name) return 0;
+      char* name2 = new char[strlen(name)+1];
+      strcpy(name2, name);
+      return name2;
+   }
 };
 
 struct MyVar: public MyObject{
@@ -94,6 +110,8 @@ struct MyVar: public MyObject{
    bool is_integer() { return type_ != VARTYPE_CONTINUOUS; }
 
 protected:
+   const char* getNamePrefix() const { return "var"; }
+
    VarType type_; //type of the variable
    double cost_; //cost of the variable
    double lb_; //lower bound
@@ -106,7 +124,7 @@ struct MyCons: public MyObject{
 { }
 
    MyCons(const MyCons& cons) :
-      MyObject(cons.name_), lhs_(cons.lhs_), rhs_(cons.rhs_)
+      MyObject(cons), lhs_(cons.lhs_), rhs_(cons.rhs_)
    { }
 
    virtual ~MyCons(){ }
@@ -124,6 +142,8 @@ struct MyCons: public MyObject{
    void setRhs(double rhs) { rhs_=rhs; }
 
 protected:
+   const char* getNamePrefix() const { return "cons"; }
+
    double lhs_; //left hand side == lower bound
    double rhs_; //rihgt hand side == upper bound
 };
@@ -142,6 +162,14 @@ struct MyPricer{
    /* perform pricing */
    //return true if optimal
    virtual bool pricing(double bound=0, bool before_fathom = true)=0;
+
+   //new pricer on the same problem, for another solving thread (0 if not available)
+   virtual MyPricer* clone() { return 0; }
+
+   //add all the columns whose reduced cost is smaller than gap (the other ones cannot be in a solution
+   //within gap of the current lower bound). Return false without adding any column if the pricer
+   //cannot enumerate them or if there are more than maxColumns of them
+   virtual bool enumerate(double gap, int maxColumns) { return false; }
 };
 /*
  * My branching rule
@@ -162,6 +190,12 @@ struct MyBranchingRule{
 
    void set_search_strategy(SearchStrategy searchStrategy){ searchStrategy_ = searchStrategy; }
 
+   //new branching rule on the same problem, for another solving thread (0 if not available)
+   virtual MyBranchingRule* clone() { return 0; }
+
+   /* current resting arcs of a nurse on a day: the arcs generated after a branching on this day join its constraint */
+   virtual void getRestVars(LiveNurse* pNurse, int day, vector<MyVar*>& restVars) { }
+
 protected:
    SearchStrategy searchStrategy_;
 };
@@ -210,6 +244,21 @@ public:
 
    virtual void addForbidenShifts(LiveNurse* pNurse, set<pair<int,int> >& forbidenShifts) { }
 
+   //days on which a branching decision on the rests of the nurse (rest or work) has been taken in the current node
+   virtual void getBranchedDays(LiveNurse* pNurse, set<int>& days) { }
+
+   //strong branching: evaluate the children (rest, work) of the branching on the rests restVars of each of restDays.
+   //Return false if the modeler cannot evaluate them, otherwise gains holds the increase of the bound of the children
+   //(-1 for a child without bound: infeasible or not solved).
+   virtual bool evaluateRestBranching(vector<pair<LiveNurse*, int> >& restDays, vector<vector<MyVar*> >& restVars,
+      vector<pair<double,double> >& gains) { return false; }
+
+   //protect the model when it is shared by several solving threads:
+   //the pricer releases it while solving the sub problems
+   virtual void lock() { }
+
+   virtual void unlock() { }
+
 
    /*
     * Class methods for pricer and branching rule
@@ -371,6 +420,24 @@ public:
       createColumn(var, var_name, objCoeff, dualObj, VARTYPE_INTEGER, cons, coeffs, transformed, score);
    }
 
+   /*
+    * Add a batch of new columns to the problem:
+    *    vars is filled with the pointers of the new columns
+    *    the coefficients of the column c are in [starts[c], starts[c+1]) of the flat arrays cons and coeffs
+    *    names can be left empty when the names are not stored
+    */
+   virtual void createColumns(vector<MyVar*>& vars, VarType vartype, vector<string>& names,
+      vector<double>& objCoeffs, vector<double>& dualObjs,
+      vector<int>& starts, vector<MyCons*>& cons, vector<double>& coeffs){
+      const int nbColumns = objCoeffs.size();
+      vars.resize(nbColumns);
+      for(int c=0; c<nbColumns; ++c){
+         vector<MyCons*> cons2(cons.begin()+starts[c], cons.begin()+starts[c+1]);
+         vector<double> coeffs2(coeffs.begin()+starts[c], coeffs.begin()+starts[c+1]);
+         createColumn(&vars[c], names.empty() ? 0 : names[c].c_str(), objCoeffs[c], dualObjs[c], vartype, cons2, coeffs2);
+      }
+   }
+
    /*
     * get the primal values
     */
@@ -443,13 +510,18 @@ public:
 
    virtual int printStats()=0;
 
+   //number of simplex iterations and time spent to solve the root node during the last solve
+   virtual int getRootLpIterations() { return 0; }
+
+   virtual double getRootLpTime() { return 0; }
+
    virtual int printBestSol()=0;
 
    virtual int writeProblem(string fileName)=0;
 
    virtual int writeLP(string fileName)=0;
 
-   virtual void toString(MyObject* obj){ cout << obj->name_ << endl; }
+   virtual void toString(MyObject* obj){ cout << obj->getName() << endl; }
 
    /**************
     * Getters *
@@ -464,6 +536,12 @@ public:
 
    inline vector<MyVar*>& getIntegerCoreVars(){ return integerCoreVars_; }
 
+   //core variables which can be fixed to 0 by reduced cost: even if continuous,
+   //their value is integer in an optimal integer solution (e.g. the resting arcs of a flow)
+   inline void addFixableCoreVar(MyVar* var){ fixableCoreVars_.push_back(var); }
+
+   inline vector<MyVar*>& getFixableCoreVars(){ return fixableCoreVars_; }
+
    inline int getVerbosity() { return verbosity_; }
 
    inline double getBestUB() { return best_ub; }
@@ -477,9 +555,19 @@ public:
 
    inline SearchStrategy getSearchStrategy(){ return searchStrategy_; }
 
-   inline void setLastBranchingRest(pair<LiveNurse*, int> lastBranchingRest){ lastBranchingRest_ = lastBranchingRest; }
+   inline virtual void setLastBranchingRest(pair<LiveNurse*, int> lastBranchingRest){ lastBranchingRest_ = lastBranchingRest; }
 
-   inline pair<LiveNurse*, int> getLastBranchingRest() { return lastBranchingRest_; }
+   inline virtual pair<LiveNurse*, int> getLastBranchingRest() { return lastBranchingRest_; }
+
+   //bounds of the children of a branching on the rest arcs restArcs of a nurse on a day, whose value is fractional:
+   //rest child in [restLb, multiplicity of the nurse], work child in [0, workUb]
+   inline void getRestBranchingBounds(vector<MyVar*>& restArcs, double& restLb, double& workUb){
+      double value = 0;
+      for(MyVar* var: restArcs)
+         value += getVarValue(var);
+      restLb = ceil(value - EPSILON);
+      workUb = floor(value + EPSILON);
+   }
 
    inline void setParameters(SolverParam parameters){ 
     parameters_ = parameters;
@@ -490,6 +578,11 @@ public:
 
    inline SolverParam& getParameters() { return parameters_; }
 
+   //name to give to a new object: 0 if the names are not stored
+   inline const char* nameToStore(const char* name) { return parameters_.storeNames_ ? name : 0; }
+
+   inline bool isStoringNames() { return parameters_.storeNames_; }
+
    inline void setLogFile(string fileName) {logfile_ = fileName;}
 
 protected:
@@ -497,6 +590,7 @@ protected:
    vector<MyObject*> objects_;
    vector<MyVar*> binaryCoreVars_;
    vector<MyVar*> integerCoreVars_;
+   vector<MyVar*> fixableCoreVars_;
 
    MyPricer* pPricer_;
    MyBranchingRule* pBranchingRule_;
@@ -15,6 +15,7 @@
 #include <string>
 #include <stdexcept>
 #include <math.h>       /* pow */
+#include <mutex>
 
 // necessary because OS X does not have clock_gettime, using clock_get_time
 #ifdef __MACH__
@@ -72,8 +73,9 @@ bool readUntilChar(fstream *file, char separateur, string *pTitle) {
 	return true;
 }
 
-//random generator of tools
+//random generator of tools, shared by all the threads
 std::minstd_rand rdm0(0);
+std::mutex rdmMutex0;
 
 // Initialize the random generator with a given seed
 void initializeRandomGenerator(){
@@ -92,6 +94,7 @@ minstd_rand getANewRandomGenerator(){
 int roundWithProbability(double number){
    //round with a certain probability to the floor or the ceil
    double probFactor = number - floor(number);
+   lock_guard<mutex> lock(rdmMutex0);
    if(rdm0() < probFactor) return (int)floor(number);
    else return (int)ceil(number);
 }
@@ -163,6 +166,7 @@ void initDoubleVector2D(vector< vector< double > > * v2D, int m, int n, double v
 //
 vector<double> randomDoubleVector(int m, double minVal, double maxVal){
 	vector<double> v1D;
+	lock_guard<mutex> lock(rdmMutex0);
 	for(int i=0; i<m; i++){
 		double a = (maxVal - minVal) * ( (double)rdm0() / (double)RAND_MAX ) + minVal;
 		v1D.push_back(a);
@@ -233,7 +237,7 @@ int containsWeekend(int start, int end){
 
 // constructor of Timer
 //
-Timer::Timer():isInit_(0), isStarted_(0), isStopped_(0) {
+Timer::Timer(bool wallClock):wallClock_(wallClock), isInit_(0), isStarted_(0), isStopped_(0) {
 	this->init();
 }
 
@@ -269,7 +273,7 @@ void Timer::start()  {
 	cpuInit_.tv_nsec = mts.tv_nsec;
 
 #else
-	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpuInit_);
+	clock_gettime(wallClock_ ? CLOCK_MONOTONIC : CLOCK_PROCESS_CPUTIME_ID, &cpuInit_);
 #endif
 
 	cpuSinceStart_.tv_sec   = 0;
@@ -299,7 +303,7 @@ void Timer::stop() {
 	cpuNow.tv_nsec = mts.tv_nsec;
 
 #else
-	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpuNow);
+	clock_gettime(wallClock_ ? CLOCK_MONOTONIC : CLOCK_PROCESS_CPUTIME_ID, &cpuNow);
 #endif
 
 	if ( cpuNow.tv_nsec-cpuInit_.tv_nsec < 0 ) {
@@ -341,7 +345,7 @@ const double Timer::dSinceInit() {
 		cpuNow.tv_nsec = mts.tv_nsec;
 
 #else
-		clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpuNow);
+		clock_gettime(wallClock_ ? CLOCK_MONOTONIC : CLOCK_PROCESS_CPUTIME_ID, &cpuNow);
 #endif
 
 		timespec cpuTmp;
@@ -394,7 +398,7 @@ const double Timer::dSinceStart() {
 		cpuNow.tv_nsec = mts.tv_nsec;
 
 #else
-		clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpuNow);
+		clock_gettime(wallClock_ ? CLOCK_MONOTONIC : CLOCK_PROCESS_CPUTIME_ID, &cpuNow);
 #endif
 
 		if ( cpuNow.tv_nsec-cpuInit_.tv_nsec < 0 ) {
@@ -148,11 +148,13 @@ class Timer
 public:
 
 	//constructor and destructor
+	//the timer measures the cpu time of the process, or the elapsed time if wallClock is true
 	//
-	Timer();
+	Timer(bool wallClock = false);
 	~Timer() {}
 
 private:
+	bool wallClock_;
 	timespec cpuInit_;
 	timespec cpuSinceStart_;
 	timespec cpuSinceInit_;
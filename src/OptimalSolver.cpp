@@ -71,6 +71,7 @@ int main(int argc, char** argv)
 //   optParam.solveToOptimality_ = true;
 //   optParam.nbDiveIfMinGap_ = 2;
 //   optParam.nbDiveIfRelGap_ = 8;
+//   optParam.portfolioSize_ = 0; //one solver per core, each with its own search strategy
 //   testMultipleWeeksDeterministic(data, inst, historyID, numberWeek, GENCOL, "outfiles/Competition/"+outdir+"/"+prefix, optParam);
 
 
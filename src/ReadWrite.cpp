@@ -23,7 +23,7 @@
 
 
 std::map<std::string, Algorithm> stringToAlgorithm =
-   boost::assign::map_list_of("GREEDY", GREEDY)("GENCOL", GENCOL)("STOCHASTIC_GREEDY",STOCHASTIC_GREEDY)("STOCHASTIC_GENCOL",STOCHASTIC_GENCOL)("NONE",NONE);
+   boost::assign::map_list_of("GREEDY", GREEDY)("GENCOL", GENCOL)("STOCHASTIC_GREEDY",STOCHASTIC_GREEDY)("STOCHASTIC_GENCOL",STOCHASTIC_GENCOL)("LAGRANGIAN",LAGRANGIAN)("NONE",NONE);
 std::map<std::string, WeightStrategy> stringToWeightStrategy =
    boost::assign::map_list_of("MAX", MAX)("MEAN", MEAN)("RANDOMMEANMAX",RANDOMMEANMAX)("BOUNDRATIO",BOUNDRATIO)("NO_STRAT",NO_STRAT);
 std::map<std::string, RankingStrategy> stringToRankingStrategy =
@@ -586,6 +586,45 @@ string ReadWrite::readStochasticSolverOptions(string strOptionFile, StochasticSo
 		if(!strcmp(title.c_str(), "nGenerationDemandsMax")){
 			file >> options.nGenerationDemandsMax_;
 		}
+		if(!strcmp(title.c_str(), "withEvaluationCache")){
+			file >> options.withEvaluationCache_;
+		}
+		if(!strcmp(title.c_str(), "evaluationRotationPoolSize")){
+			file >> options.evaluationRotationPoolSize_;
+		}
+		if(!strcmp(title.c_str(), "withRacing")){
+			file >> options.withRacing_;
+		}
+		if(!strcmp(title.c_str(), "racingMinDemands")){
+			file >> options.racingMinDemands_;
+		}
+		if(!strcmp(title.c_str(), "racingConfidence")){
+			file >> options.racingConfidence_;
+		}
+		if(!strcmp(title.c_str(), "withAdaptiveTimeBudget")){
+			file >> options.withAdaptiveTimeBudget_;
+		}
+		if(!strcmp(title.c_str(), "timeBudgetMarginSeconds")){
+			file >> options.timeBudgetMarginSeconds_;
+		}
+		if(!strcmp(title.c_str(), "withEvaluationCutOff")){
+			file >> options.withEvaluationCutOff_;
+		}
+		if(!strcmp(title.c_str(), "withGreedyPreScreen")){
+			file >> options.withGreedyPreScreen_;
+		}
+		if(!strcmp(title.c_str(), "preScreenFraction")){
+			file >> options.preScreenFraction_;
+		}
+		if(!strcmp(title.c_str(), "pipelineGenerationEvaluation")){
+			file >> options.pipelineGenerationEvaluation_;
+		}
+		if(!strcmp(title.c_str(), "nGenerationThreads")){
+			file >> options.nGenerationThreads_;
+		}
+		if(!strcmp(title.c_str(), "nEvaluationThreads")){
+			file >> options.nEvaluationThreads_;
+		}
 	}
 
    std::fstream file2;
@@ -644,6 +683,42 @@ string ReadWrite::readSolverOptions(string strOptionFile, SolverParam& options)
 		if(!strcmp(title.c_str(), "stopAfterXSolution")){
 			file >> options.stopAfterXSolution_;
 		}
+		if(!strcmp(title.c_str(), "mipHeuristicTime")){
+			file >> options.mipHeuristicTime_;
+		}
+		if(!strcmp(title.c_str(), "strongBranchingSize")){
+			file >> options.strongBranchingSize_;
+		}
+		if(!strcmp(title.c_str(), "strongBranchingIterations")){
+			file >> options.strongBranchingIterations_;
+		}
+		if(!strcmp(title.c_str(), "lazyLongRests")){
+			file >> options.lazyLongRests_;
+		}
+		if(!strcmp(title.c_str(), "aggregateNurses")){
+			file >> options.aggregateNurses_;
+		}
+		if(!strcmp(title.c_str(), "enumerationGap")){
+			file >> options.enumerationGap_;
+		}
+		if(!strcmp(title.c_str(), "enumerationMaxColumns")){
+			file >> options.enumerationMaxColumns_;
+		}
+		if(!strcmp(title.c_str(), "lagrangianIterations")){
+			file >> options.lagrangianIterations_;
+		}
+		if(!strcmp(title.c_str(), "storeNames")){
+			file >> options.storeNames_;
+		}
+		if(!strcmp(title.c_str(), "nbThreads")){
+			file >> options.nbThreads_;
+		}
+		if(!strcmp(title.c_str(), "nbPricingThreads")){
+			file >> options.nbPricingThreads_;
+		}
+		if(!strcmp(title.c_str(), "portfolioSize")){
+			file >> options.portfolioSize_;
+		}
 	}
 
    std::fstream file2;
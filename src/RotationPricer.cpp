@@ -23,14 +23,23 @@ static char* baseName = "rotation";
 /* Constructs the pricer object. */
 RotationPricer::RotationPricer(MasterProblem* master, const char* name):
                         MyPricer(name), nbMaxRotationsToAdd_(20), nbSubProblemsToSolve_(15), nursesToSolve_(master->theNursesSorted_),
-                        master_(master), pScenario_(master->pScenario_), nbDays_(master->pDemand_->nbDays_), pModel_(master->getModel())
+                        master_(master), pScenario_(master->pScenario_), nbDays_(master->pDemand_->nbDays_), pModel_(master->getModel()),
+                        stopWorkers_(false), dualsVersion_(0), nextNurse_(0), asyncBound_(0)
 {
    /* sort the nurses */
 //   random_shuffle( nursesToSolve_.begin(), nursesToSolve_.end());
+   //shuffle them to diversify the columns generated by the solvers of a portfolio
+   const int seed = pModel_->getParameters().pricerSeed_;
+   if(seed > 0)
+      shuffle(nursesToSolve_.begin(), nursesToSolve_.end(), minstd_rand(seed));
+   //the nurses aggregated in the block of another nurse are priced with it
+   nursesToSolve_.erase(remove_if(nursesToSolve_.begin(), nursesToSolve_.end(),
+      [](LiveNurse* pNurse) { return pNurse->multiplicity_ == 0; }), nursesToSolve_.end());
 }
 
 /* Destructs the pricer object. */
 RotationPricer::~RotationPricer() {
+   stopWorkers();
    for(pair<const Contract*, SubProblem*> p: subProblems_)
       delete p.second;
 }
@@ -39,12 +48,18 @@ RotationPricer::~RotationPricer() {
  * Perform pricing
  ******************************************************/
 bool RotationPricer::pricing(double bound, bool before_fathom){
+   //the workers need their own copy of the duals: only possible when the model is not shared with other solving threads
+   if(pModel_->getParameters().nbPricingThreads_ > 0 && master_->solverType_ == S_BCP)
+      return pricingAsync(bound);
+
    //=false if once optimality hasn't be proven
    bool optimal = true;
    //forbidden shifts
    set<pair<int,int> > forbiddenShifts;
    //computed new rotations
    vector<Rotation> rotations;
+   //rotations to add to the master problem at the end of the round
+   vector<Rotation> newRotations;
 
 //   std::cout << "# ------- BEGIN ------- Subproblems..." << std::endl;
 
@@ -57,19 +72,7 @@ bool RotationPricer::pricing(double bound, bool before_fathom){
       LiveNurse* pNurse = *it0;
 
       /* Build or re-use a subproblem */
-      SubProblem* subProblem;
-      //search the contract
-      map<const Contract*, SubProblem*>::iterator it =  subProblems_.find(pNurse->pContract_);
-
-      //if doesn't find => create new subproblem
-      if( it == subProblems_.end() ){
-         subProblem = new SubProblem(pScenario_, nbDays_, pNurse->pContract_, master_->pInitState_);
-         subProblems_.insert(it, pair<const Contract*, SubProblem*>(pNurse->pContract_, subProblem));
-      }
-
-      //otherwise retrieve the subproblem associated to the contract
-      else
-         subProblem = it->second;
+      SubProblem* subProblem = getSubProblem(pNurse);
 
       /* Retrieves dual values */
       vector< vector<double> > workDualCosts(getWorkDualValues(pNurse));
@@ -93,7 +96,10 @@ bool RotationPricer::pricing(double bound, bool before_fathom){
       optimal = false;
 
 
+      //the sub problem does not use the model: release it for the other solving threads
+      pModel_->unlock();
       subProblem->solve(pNurse, &dualCosts, options, forbiddenShifts, true , 120, bound);
+      pModel_->lock();
 
 
 	   /*
@@ -108,11 +114,11 @@ bool RotationPricer::pricing(double bound, bool before_fathom){
 //         rot.computeDualCost(dualCosts);
       }
 		std::stable_sort(rotations.begin(), rotations.end(), Rotation::compareDualCost);
-		/* add them to the master problem */
+		/* select them for the master problem */
 		int nbRotationsAdded = 0;
 		double best;
 		for(Rotation& rot: rotations){
-			master_->addRotation(rot, baseName);
+			newRotations.push_back(rot);
 			++nbRotationsAdded;
 			if(nbRotationsAdded >= nbMaxRotationsToAdd_)
 			   break;
@@ -136,6 +142,13 @@ bool RotationPricer::pricing(double bound, bool before_fathom){
 		   break;
    }
 
+   //Add the long resting arcs with a negative reduced cost
+   if(master_->lazyLongRests_)
+      priceLongRests();
+
+   //Add all the selected rotations to the master problem at once
+   master_->addRotations(newRotations, baseName);
+
    //Add the nurse in nursesSolved at the end
    nursesToSolve_.insert(nursesToSolve_.end(), nursesSolved.begin(), nursesSolved.end());
 
@@ -151,6 +164,346 @@ bool RotationPricer::pricing(double bound, bool before_fathom){
    return optimal;
 }
 
+/******************************************************
+ * Asynchronous pricing
+ ******************************************************/
+bool RotationPricer::pricingAsync(double bound){
+   //duals of the current LP for all the nurses
+   if(workers_.empty())
+      startWorkers();
+   vector<shared_ptr<PricingDuals> > duals(pScenario_->nbNurses_);
+   for(LiveNurse* pNurse: asyncNurses_)
+      duals[pNurse->id_] = getPricingDuals(pNurse);
+
+   //publish them to the workers
+   vector<Rotation> newRotations;
+   unique_lock<mutex> lock(asyncMutex_);
+   ++dualsVersion_;
+   publishedDuals_.swap(duals);
+   asyncBound_ = bound;
+   newDuals_.notify_all();
+
+   //wait until some rotations improve the current LP, or until all the nurses have been priced with its duals
+   while(true){
+      if(workerException_)
+         rethrow_exception(workerException_);
+
+      //the rotations found with older duals or at another node may not improve the current LP
+      for(Rotation& rot: foundRotations_)
+         if(isImproving(rot, *publishedDuals_[rot.pNurse_->id_], bound))
+            newRotations.push_back(rot);
+      foundRotations_.clear();
+      if(!newRotations.empty())
+         break;
+
+      bool allPriced = true;
+      for(LiveNurse* pNurse: asyncNurses_)
+         if(pricedVersions_[pNurse->id_] < dualsVersion_){
+            allPriced = false;
+            break;
+         }
+      if(allPriced)
+         break;
+
+      newRotations_.wait(lock);
+   }
+   lock.unlock();
+
+   //Add the long resting arcs with a negative reduced cost
+   if(master_->lazyLongRests_)
+      priceLongRests(bound);
+
+   //Add all the rotations to the master problem at once
+   master_->addRotations(newRotations, baseName);
+
+   //set statistics
+   BcpModeler* model = dynamic_cast<BcpModeler*>(pModel_);
+   if(model){
+      set<int> nurses;
+      double minDualCost = 0;
+      for(Rotation& rot: newRotations){
+         nurses.insert(rot.pNurse_->id_);
+         minDualCost = min(minDualCost, rot.dualCost_);
+      }
+      model->setLastNbSubProblemsSolved(nurses.size());
+      model->setLastMinDualCost(minDualCost);
+   }
+
+   return newRotations.empty();
+}
+
+void RotationPricer::startWorkers(){
+   asyncNurses_ = nursesToSolve_;
+   publishedDuals_.resize(pScenario_->nbNurses_);
+   pricedVersions_.assign(pScenario_->nbNurses_, 0);
+   beingPriced_.assign(pScenario_->nbNurses_, false);
+   for(int t=0; t<pModel_->getParameters().nbPricingThreads_; ++t){
+      //each worker solves its own sub problems
+      workerPricers_.push_back(new RotationPricer(master_, name_));
+      workers_.push_back(thread(&RotationPricer::runWorker, this, workerPricers_.back()));
+   }
+}
+
+void RotationPricer::stopWorkers(){
+   {
+      lock_guard<mutex> lock(asyncMutex_);
+      stopWorkers_ = true;
+      newDuals_.notify_all();
+   }
+   for(thread& worker: workers_)
+      worker.join();
+   for(RotationPricer* pWorker: workerPricers_)
+      delete pWorker;
+   workers_.clear();
+   workerPricers_.clear();
+}
+
+void RotationPricer::runWorker(RotationPricer* pWorker){
+   unique_lock<mutex> lock(asyncMutex_);
+   while(!stopWorkers_){
+      //next nurse which has not been priced with the last duals
+      LiveNurse* pNurse = 0;
+      const int nbNurses = asyncNurses_.size();
+      for(int n=0; n<nbNurses; ++n){
+         LiveNurse* pNurse2 = asyncNurses_[(nextNurse_+n) % nbNurses];
+         if(pricedVersions_[pNurse2->id_] < dualsVersion_ && !beingPriced_[pNurse2->id_]){
+            pNurse = pNurse2;
+            nextNurse_ = (nextNurse_+n+1) % nbNurses;
+            break;
+         }
+      }
+      if(!pNurse){
+         newDuals_.wait(lock);
+         continue;
+      }
+
+      //solve its sub problem without blocking the other workers and the LP
+      const int i = pNurse->id_, version = dualsVersion_;
+      const double bound = asyncBound_;
+      shared_ptr<PricingDuals> pDuals = publishedDuals_[i];
+      beingPriced_[i] = true;
+      lock.unlock();
+
+      vector<Rotation> rotations;
+      exception_ptr e;
+      try{
+         rotations = pWorker->solveSubProblem(pNurse, *pDuals, bound);
+      }
+      catch(...){
+         e = current_exception();
+      }
+
+      lock.lock();
+      beingPriced_[i] = false;
+      pricedVersions_[i] = version;
+      if(e && !workerException_)
+         workerException_ = e;
+      foundRotations_.insert(foundRotations_.end(), rotations.begin(), rotations.end());
+      newRotations_.notify_all();
+   }
+}
+
+shared_ptr<PricingDuals> RotationPricer::getPricingDuals(LiveNurse* pNurse){
+   shared_ptr<PricingDuals> pDuals(new PricingDuals());
+   pDuals->workDualCosts_ = getWorkDualValues(pNurse);
+   pDuals->startWorkDualCosts_ = getStartWorkDualValues(pNurse);
+   pDuals->endWorkDualCosts_ = getEndWorkDualValues(pNurse);
+   pDuals->workedWeekendDualCost_ = getWorkedWeekendDualValue(pNurse);
+   pModel_->addForbidenShifts(pNurse, pDuals->forbiddenShifts_);
+   return pDuals;
+}
+
+bool RotationPricer::isImproving(Rotation& rotation, PricingDuals& duals, double bound){
+   double dualCost = rotation.cost_ - duals.startWorkDualCosts_[rotation.firstDay_]
+      - duals.endWorkDualCosts_[rotation.firstDay_+rotation.length_-1];
+   if(Tools::isSunday(rotation.firstDay_))
+      dualCost -= duals.workedWeekendDualCost_;
+   for(pair<const int,int>& p: rotation.shifts_){
+      if(duals.forbiddenShifts_.count(p))
+         return false;
+      dualCost -= duals.workDualCosts_[p.first][p.second-1];
+      if(Tools::isSaturday(p.first))
+         dualCost -= duals.workedWeekendDualCost_;
+   }
+   rotation.dualCost_ = dualCost;
+   return dualCost < bound - EPSILON;
+}
+
+/******************************************************
+ * Solve the sub problem of a nurse
+ ******************************************************/
+SubProblem* RotationPricer::getSubProblem(LiveNurse* pNurse){
+   //search the contract
+   map<const Contract*, SubProblem*>::iterator it =  subProblems_.find(pNurse->pContract_);
+
+   //if doesn't find => create new subproblem
+   if( it == subProblems_.end() ){
+      SubProblem* subProblem = new SubProblem(pScenario_, nbDays_, pNurse->pContract_, master_->pInitState_);
+      subProblems_.insert(it, pair<const Contract*, SubProblem*>(pNurse->pContract_, subProblem));
+      return subProblem;
+   }
+
+   //otherwise retrieve the subproblem associated to the contract
+   return it->second;
+}
+
+vector<Rotation> RotationPricer::solveSubProblem(LiveNurse* pNurse, PricingDuals& duals, double bound){
+   SubProblem* subProblem = getSubProblem(pNurse);
+   DualCosts dualCosts (duals.workDualCosts_, duals.startWorkDualCosts_, duals.endWorkDualCosts_,
+      duals.workedWeekendDualCost_, true);
+
+   /* Solve options */
+   vector<SolveOption> options;
+   options.push_back(SOLVE_ONE_SINK_PER_LAST_DAY);
+   options.push_back(SOLVE_SHORT_ALL);
+   subProblem->solve(pNurse, &dualCosts, options, duals.forbiddenShifts_, true , 120, bound);
+
+   /* Retrieve the best rotations */
+   vector<Rotation> rotations = subProblem->getRotations();
+   for(Rotation& rot: rotations)
+      rot.computeCost(pScenario_, master_->pPreferences_, nbDays_);
+   std::stable_sort(rotations.begin(), rotations.end(), Rotation::compareDualCost);
+   if(rotations.size() > nbMaxRotationsToAdd_)
+      rotations.erase(rotations.begin()+nbMaxRotationsToAdd_, rotations.end());
+   return rotations;
+}
+
+/******************************************************
+ * Price the long resting arcs which do not start on the first day
+ ******************************************************/
+void RotationPricer::priceLongRests(double bound){
+   for(LiveNurse* pNurse: master_->theLiveNurses_){
+      if(pNurse->multiplicity_ == 0)
+         continue;
+      const int i = pNurse->id_;
+      //with BCP, the branching rows only contain the arcs existing when they have been created:
+      //no new arc can rest on a day with a branching decision for the nurse.
+      //The ClpModeler shares its columns between all the nodes, so it adds the new arcs to its rest rows as well.
+      set<int> branchedDays;
+      pModel_->getBranchedDays(pNurse, branchedDays);
+
+      for(int k=1; k<nbDays_; ++k){
+         //out-flow of the resting node k, in-flow of the working node k+l (or of the sink)
+         double restDual = pModel_->getDual(master_->restFlowCons_[i][k], true);
+         for(int l=1; l<=master_->nbLongRestingArcs_[i] && k+l<=nbDays_; ++l){
+            if(branchedDays.count(k+l-1))
+               break;
+            if(master_->longRestColumns_[i].count(pair<int,int>(k, l)))
+               continue;
+            double coeff = (k+l == nbDays_) ? 1.0 : -1.0;
+            double dualCost = master_->getLongRestCost(i, k, l) - restDual
+               - coeff * pModel_->getDual(master_->workFlowCons_[i][k+l-1], true);
+            if(dualCost < bound - EPSILON)
+               master_->addLongRest(i, k, l, dualCost);
+         }
+      }
+   }
+}
+
+/******************************************************
+ * Enumerate all the columns whose reduced cost is smaller than gap
+ ******************************************************/
+bool RotationPricer::enumerate(double gap, int maxColumns){
+   vector<Rotation> rotations;
+   for(LiveNurse* pNurse: master_->theLiveNurses_){
+      if(pNurse->multiplicity_ == 0)
+         continue;
+
+      /* Retrieve dual values */
+      vector< vector<double> > workDualCosts(getWorkDualValues(pNurse));
+      vector<double> startWorkDualCosts(getStartWorkDualValues(pNurse));
+      vector<double> endWorkDualCosts(getEndWorkDualValues(pNurse));
+      double workedWeekendDualCost = getWorkedWeekendDualValue(pNurse);
+      DualCosts dualCosts (workDualCosts, startWorkDualCosts, endWorkDualCosts, workedWeekendDualCost, true);
+
+      //lower bound of the reduced cost of the days after k when day k is worked: stop on day k or work on day k+1
+      vector<double> bestCompletion(nbDays_);
+      bestCompletion[nbDays_-1] = -dualCosts.endWorkCost(nbDays_-1);
+      for(int k=nbDays_-2; k>=0; --k){
+         double bestNextDay = DBL_MAX;
+         for(int s=1; s<pScenario_->nbShifts_; ++s)
+            bestNextDay = min(bestNextDay, -dualCosts.dayShiftWorkCost(k+1, s-1));
+         if(Tools::isSaturday(k+1))
+            bestNextDay -= dualCosts.workedWeekendCost();
+         bestCompletion[k] = min(-dualCosts.endWorkCost(k), bestNextDay + bestCompletion[k+1]);
+      }
+
+      //the rotations already in the master are not generated again
+      set<map<int,int> > existingRotations;
+      for(pair<MyVar* const, Rotation>& p: master_->getRotations()[pNurse->id_])
+         existingRotations.insert(p.second.shifts_);
+
+      for(int k=0; k<nbDays_; ++k){
+         vector<int> shifts;
+         double dualCost = -dualCosts.startWorkCost(k);
+         if(Tools::isSunday(k))
+            dualCost -= dualCosts.workedWeekendCost();
+         if(!enumerateRotations(pNurse, k, shifts, dualCost, 0, dualCosts, bestCompletion, gap, existingRotations,
+            maxColumns, rotations))
+            return false;
+      }
+   }
+
+   //Add all the rotations and the long resting arcs to the master problem at once
+   master_->addRotations(rotations, baseName);
+   if(master_->lazyLongRests_)
+      priceLongRests(gap);
+
+   return true;
+}
+
+bool RotationPricer::enumerateRotations(LiveNurse* pNurse, int firstDay, vector<int>& shifts, double dualCost, double penaltyLb,
+   DualCosts& dualCosts, vector<double>& bestCompletion, double gap, set<map<int,int> >& existingRotations,
+   int maxRotations, vector<Rotation>& rotations){
+   const int k = firstDay + shifts.size();
+   //a rotation starting on the first day continues the one of the initial state
+   const bool continuesHistory = (firstDay == 0) && (pNurse->pStateIni_->shift_ > 0);
+   const int lastShift = shifts.empty() ? (continuesHistory ? pNurse->pStateIni_->shift_ : 0) : shifts.back();
+   const int nbInitConsDaysWorked = continuesHistory ? pNurse->pStateIni_->consDaysWorked_ : 0;
+   const int nbConsDaysWorked = nbInitConsDaysWorked + shifts.size() + 1;
+
+   for(int s=1; s<pScenario_->nbShifts_; ++s){
+      if(lastShift > 0 && pScenario_->isForbiddenSuccessor(s, lastShift))
+         continue;
+
+      double newDualCost = dualCost - dualCosts.dayShiftWorkCost(k, s-1);
+      if(Tools::isSaturday(k))
+         newDualCost -= dualCosts.workedWeekendCost();
+      //the penalties of the preferences and of the consecutive worked days above the maximum cannot decrease
+      //when the rotation is extended: the other ones are ignored by the bound
+      double newPenaltyLb = penaltyLb;
+      if(master_->pPreferences_->wantsTheShiftOff(pNurse->id_, k, s))
+         newPenaltyLb += WEIGHT_PREFERENCES;
+      if(nbConsDaysWorked > max(nbInitConsDaysWorked, pNurse->maxConsDaysWork()))
+         newPenaltyLb += WEIGHT_CONS_DAYS_WORK;
+      if(newDualCost + newPenaltyLb + bestCompletion[k] > gap + EPSILON)
+         continue;
+
+      shifts.push_back(s);
+
+      //the rotation stops on day k
+      Rotation rotation(firstDay, shifts, pNurse);
+      if(!existingRotations.count(rotation.shifts_)){
+         rotation.computeCost(pScenario_, master_->pPreferences_, nbDays_);
+         rotation.dualCost_ = rotation.cost_ + newDualCost - dualCosts.endWorkCost(k);
+         if(rotation.dualCost_ < gap + EPSILON){
+            rotations.push_back(rotation);
+            if(rotations.size() > maxRotations)
+               return false;
+         }
+      }
+
+      //the rotation goes on
+      if(k+1 < nbDays_ && !enumerateRotations(pNurse, firstDay, shifts, newDualCost, newPenaltyLb, dualCosts,
+         bestCompletion, gap, existingRotations, maxRotations, rotations))
+         return false;
+
+      shifts.pop_back();
+   }
+
+   return true;
+}
+
 /******************************************************
  * Get the duals values per day for a nurse
  ******************************************************/
@@ -274,7 +627,8 @@ bool compareObject(const pair<MyVar*,double>& p1, const pair<MyVar*,double>& p2)
 
 /* Constructs the branching rule object. */
 DiveBranchingRule::DiveBranchingRule(MasterProblem* master, const char* name):
-                        MyBranchingRule(name), master_(master), pModel_(master->getModel()), nbBranchingCandidates_(5)
+                        MyBranchingRule(name), master_(master), pModel_(master->getModel()), nbBranchingCandidates_(5),
+                        pPseudoCosts_(new RestPseudoCosts(master->theLiveNurses_.size(), master->pDemand_->nbDays_))
 { }
 
 //add all good candidates
@@ -316,18 +670,23 @@ void DiveBranchingRule::branchOnRestingArcs(vector<MyVar*>& branchingCandidates)
    LiveNurse* pBestNurse(nullptr);
    double bestValue = DBL_MAX;
 
-   for(LiveNurse* pNurse: master_->theLiveNurses_)
-      for(int k=0; k<master_->pDemand_->nbDays_; ++k){
+   if(pModel_->getParameters().strongBranchingSize_ > 0){
+      pair<LiveNurse*, int> bestRest = strongBranchOnRestingArcs();
+      pBestNurse = bestRest.first;
+      bestDay = bestRest.second;
+   }
+   else for(LiveNurse* pNurse: master_->theLiveNurses_)
+      for(int k=0; k<master_->pDemand_->nbDays_ && pNurse->multiplicity_ > 0; ++k){
          double value = 0;
          //choose the set of arcs the closest to .5
          for(MyVar* var: master_->getRestsPerDay(pNurse)[k])
             value += pModel_->getVarValue(var);
 
-         //The value has to be not integer
-         if(value < EPSILON || value > 1 - EPSILON)
+         //The value has to be not integer (it is in [0, multiplicity] for a block of identical nurses)
+         double frac = value - floor(value);
+         if(frac < EPSILON || frac > 1 - EPSILON)
             continue;
 
-         double frac = value - floor(value);
          double closeTo5 = abs(0.5-frac);
 
          if(closeTo5 < bestValue){
@@ -346,19 +705,92 @@ void DiveBranchingRule::branchOnRestingArcs(vector<MyVar*>& branchingCandidates)
    master_->pModel_->setLastBranchingRest(pair<LiveNurse*, int>(pBestNurse, bestDay));
 }
 
+/* choose the set of resting arcs with strong branching and pseudo-costs:
+ * the candidates are sorted by pseudo-cost score (or closeness to .5 if never evaluated),
+ * then the best ones which have not been evaluated enough are evaluated by the modeler
+ * (the children are solved with a limited column generation) and the one with the best
+ * product of the gains of its children is chosen */
+pair<LiveNurse*, int> DiveBranchingRule::strongBranchOnRestingArcs(){
+   //number of evaluations after which the pseudo-costs of a rest decision are trusted
+   static const int reliability = 2;
+
+   //fractional sets of rest arcs and the fractional part of their value
+   vector<pair<LiveNurse*, int> > rests;
+   vector<double> values;
+   for(LiveNurse* pNurse: master_->theLiveNurses_)
+      for(int k=0; k<master_->pDemand_->nbDays_ && pNurse->multiplicity_ > 0; ++k){
+         double value = 0;
+         for(MyVar* var: master_->getRestsPerDay(pNurse)[k])
+            value += pModel_->getVarValue(var);
+         //The value has to be not integer
+         double frac = value - floor(value);
+         if(frac < EPSILON || frac > 1 - EPSILON)
+            continue;
+         rests.push_back(pair<LiveNurse*, int>(pNurse, k));
+         values.push_back(frac);
+      }
+
+   if(rests.empty())
+      return pair<LiveNurse*, int>(nullptr, -1);
+
+   //order of the candidates: the ones never evaluated come first, closest to .5 first,
+   //then the others by decreasing pseudo-cost score
+   vector<pair<double, int> > candidates;
+   for(int i=0; i<rests.size(); ++i){
+      const int id = rests[i].first->id_, day = rests[i].second;
+      double score = (pPseudoCosts_->getNbEvaluations(id, day) == 0) ?
+         LARGE_SCORE - abs(0.5-values[i]) : pPseudoCosts_->getScore(id, day, values[i]);
+      candidates.push_back(pair<double, int>(-score, i));
+   }
+   stable_sort(candidates.begin(), candidates.end());
+
+   //evaluate the best candidates whose pseudo-costs are not reliable
+   vector<int> evaluated;
+   vector<pair<LiveNurse*, int> > restDays;
+   vector<vector<MyVar*> > restVars;
+   for(int j=0; j<candidates.size() && evaluated.size()<pModel_->getParameters().strongBranchingSize_; ++j){
+      pair<LiveNurse*, int>& rest = rests[candidates[j].second];
+      if(pPseudoCosts_->getNbEvaluations(rest.first->id_, rest.second) >= reliability)
+         continue;
+      evaluated.push_back(candidates[j].second);
+      restDays.push_back(rest);
+      restVars.push_back(master_->getRestsPerDay(rest.first)[rest.second]);
+   }
+
+   //without evaluation, keep the first candidate
+   vector<pair<double,double> > gains;
+   if(evaluated.empty() || !pModel_->evaluateRestBranching(restDays, restVars, gains))
+      return rests[candidates[0].second];
+
+   for(int j=0; j<evaluated.size(); ++j)
+      pPseudoCosts_->update(restDays[j].first->id_, restDays[j].second, values[evaluated[j]],
+         gains[j].first, gains[j].second);
+
+   //choose the best score among the candidates which have been evaluated
+   int best = candidates[0].second;
+   double bestScore = -1;
+   for(int i=0; i<rests.size(); ++i){
+      const int id = rests[i].first->id_, day = rests[i].second;
+      if(pPseudoCosts_->getNbEvaluations(id, day) == 0)
+         continue;
+      double score = pPseudoCosts_->getScore(id, day, values[i]);
+      if(score > bestScore){
+         best = i;
+         bestScore = score;
+      }
+   }
+
+   return rests[best];
+}
+
 /* branch on the number of nurses */
 void DiveBranchingRule::branchOnNumberOfNurses(vector<MyVar*>& branchingCandidates){
    //search all candidates
-   if(mediumCandidates_.size() == 0)
-      for(MyVar* var: pModel_->getIntegerCoreVars()){
-         string str2 = "nursesNumber";
-         string str0(var->name_);
-         string str1 = str0.substr(0,str2.size());
-         if(strcmp(str1.c_str(), str2.c_str()) == 0)
-            bestCandidates_.push_back(var);
-         else
-            mediumCandidates_.push_back(var);
-      }
+   //the integer core variables are the number of nurses by position and the skill allocations
+   if(mediumCandidates_.size() == 0){
+      bestCandidates_ = master_->getNursesNumberVars();
+      mediumCandidates_ = master_->getSkillsAllocVars();
+   }
 
    MyVar *bestVar(0);
    double bestValue = DBL_MAX;
@@ -464,30 +896,20 @@ bool DiveBranchingRule::compareColumnCloseTo5(pair<MyVar*, double> obj1, pair<My
  *************************************************************/
 
 /* Constructs the branching rule object. */
-CorePriorityBranchingRule::CorePriorityBranchingRule(Modeler* pModel, const char* name):
-                        MyBranchingRule(name), pModel_(pModel)
+CorePriorityBranchingRule::CorePriorityBranchingRule(MasterProblem* master, const char* name):
+                        MyBranchingRule(name), master_(master), pModel_(master->getModel())
 { }
 
 //remove all bad candidates from fixingCandidates while keeping the order
 void CorePriorityBranchingRule::logical_fixing(vector<MyVar*>& fixingCandidates){
    //choose the var nursesNumber
-   for(MyVar* var: pModel_->getIntegerCoreVars()){
-      string str2 = "nursesNumber";
-      string str0(var->name_);
-      string str1 = str0.substr(0,str2.size());
-      if(strcmp(str1.c_str(), str2.c_str()) == 0)
-         fixingCandidates.push_back(var);
-   }
+   for(MyVar* var: master_->getNursesNumberVars())
+      fixingCandidates.push_back(var);
 }
 
 //remove all worst/best candidates from fixingCandidates while keeping the order
 void CorePriorityBranchingRule::branching_candidates(vector<MyVar*>& branchingCandidates){
-   //choose the var nursesNumber
-   for(MyVar* var: pModel_->getIntegerCoreVars()){
-      string str2 = "skillsAlloc";
-      string str0(var->name_);
-      string str1 = str0.substr(0,str2.size());
-      if(strcmp(str1.c_str(), str2.c_str()) == 0)
-         branchingCandidates.push_back(var);
-   }
+   //choose the var skillsAlloc
+   for(MyVar* var: master_->getSkillsAllocVars())
+      branchingCandidates.push_back(var);
 }
@@ -15,18 +15,41 @@
 #include "SubProblem.h"
 #include "Modeler.h"
 
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
 /* namespace usage */
 using namespace std;
 
+//duals and branching decisions of a nurse published to the asynchronous pricing workers
+struct PricingDuals{
+   vector< vector<double> > workDualCosts_;
+   vector<double> startWorkDualCosts_, endWorkDualCosts_;
+   double workedWeekendDualCost_;
+   set<pair<int,int> > forbiddenShifts_;
+};
+
 class RotationPricer: public MyPricer
 {
 public:
    RotationPricer(MasterProblem* master, const char* name);
    virtual ~RotationPricer();
 
-   /* perform pricing */
+   /* perform pricing: asynchronous if nbPricingThreads_ > 0 with BCP */
    bool pricing(double bound=0, bool before_fathom = true);
 
+   /* new pricer with its own sub problems */
+   MyPricer* clone() { return new RotationPricer(master_, name_); }
+
+   /* add the long resting arcs with a reduced cost smaller than bound (lazy long rests) */
+   void priceLongRests(double bound = 0);
+
+   /* add all the rotations and the long resting arcs whose reduced cost is smaller than gap */
+   bool enumerate(double gap, int maxColumns);
+
 private:
    //Pointer to the master problem to link the master and the sub problems
    //
@@ -49,10 +72,53 @@ private:
     */
    int nbMaxRotationsToAdd_, nbSubProblemsToSolve_;
 
+   /*
+    * Asynchronous pricing: the workers solve the sub problems in the background with the last duals published,
+    * while pricingAsync only publishes the duals of the current LP and collects the rotations found so far
+    */
+   vector<thread> workers_;
+   vector<RotationPricer*> workerPricers_;
+   //protect all the following members, which are shared with the workers
+   mutex asyncMutex_;
+   condition_variable newDuals_, newRotations_;
+   bool stopWorkers_;
+   exception_ptr workerException_;
+   //version of the last duals published, and for each nurse: its last duals published,
+   //the version of the duals of its last pricing and if a worker is pricing it
+   int dualsVersion_;
+   vector<shared_ptr<PricingDuals> > publishedDuals_;
+   vector<int> pricedVersions_;
+   vector<bool> beingPriced_;
+   //the workers take the nurses in this order, starting after the last nurse taken
+   vector<LiveNurse*> asyncNurses_;
+   int nextNurse_;
+   double asyncBound_;
+   //rotations found by the workers and not collected yet
+   vector<Rotation> foundRotations_;
+
+   bool pricingAsync(double bound);
+   void startWorkers();
+   void stopWorkers();
+   void runWorker(RotationPricer* pWorker);
+
+   //duals of the current LP and branching decisions of the current node for the nurse
+   shared_ptr<PricingDuals> getPricingDuals(LiveNurse* pNurse);
+
+   //true if the rotation has a reduced cost under bound for duals and does not use any of their forbidden shifts
+   bool isImproving(Rotation& rotation, PricingDuals& duals, double bound);
+
    /*
     * Methods
     */
 
+   //sub problem of the contract of the nurse (created if needed)
+   //
+   SubProblem* getSubProblem(LiveNurse* pNurse);
+
+   //solve the sub problem of the nurse: return its best rotations (at most nbMaxRotationsToAdd_)
+   //
+   vector<Rotation> solveSubProblem(LiveNurse* pNurse, PricingDuals& duals, double bound);
+
    //get the duals values per day and per shift for a nurse
    //
    vector< vector<double> > getWorkDualValues(LiveNurse* pNurse);
@@ -63,10 +129,57 @@ private:
    //compute some forbidden shifts from the lasts rotations and forbidden shifts
    //
    void computeForbiddenShifts(set<pair<int,int> >& forbiddenShifts, vector<Rotation> rotations);
+
+   //enumerate the rotations of pNurse starting on firstDay with the shifts of shifts, a reduced cost smaller than gap,
+   //and which are not in existingRotations. dualCost is the dual part of the reduced cost of the days of shifts,
+   //penaltyLb a lower bound of their penalties and bestCompletion[k] a lower bound of the reduced cost of the days
+   //after k when day k is worked. Return false as soon as rotations contains more than maxRotations rotations
+   //
+   bool enumerateRotations(LiveNurse* pNurse, int firstDay, vector<int>& shifts, double dualCost, double penaltyLb,
+      DualCosts& dualCosts, vector<double>& bestCompletion, double gap, set<map<int,int> >& existingRotations,
+      int maxRotations, vector<Rotation>& rotations);
 };
 
 static bool compareObject(const pair<MyVar*,double>& p1, const pair<MyVar*,double>& p2);
 
+//pseudo-costs of the rest branching decisions per (nurse, day): sum of the increases of the bound
+//per unit of change of the rest value, for the rest child and for the work child
+struct RestPseudoCosts{
+   RestPseudoCosts(int nbNurses, int nbDays):
+      restGains_(nbNurses, vector<double>(nbDays, 0)), workGains_(nbNurses, vector<double>(nbDays, 0)),
+      nbEvaluations_(nbNurses, vector<int>(nbDays, 0)), nbRestGains_(nbNurses, vector<int>(nbDays, 0)),
+      nbWorkGains_(nbNurses, vector<int>(nbDays, 0))
+   { }
+
+   //store the gains of the children of the decision on a rest whose value was value:
+   //a negative gain (child without bound) is not averaged, only the evaluation is counted
+   void update(int nurse, int day, double value, double restGain, double workGain){
+      if(restGain >= 0){
+         restGains_[nurse][day] += restGain / (1 - value);
+         ++nbRestGains_[nurse][day];
+      }
+      if(workGain >= 0){
+         workGains_[nurse][day] += workGain / value;
+         ++nbWorkGains_[nurse][day];
+      }
+      ++nbEvaluations_[nurse][day];
+   }
+
+   int getNbEvaluations(int nurse, int day) { return nbEvaluations_[nurse][day]; }
+
+   //product of the estimated gains of the two children (the higher, the better)
+   double getScore(int nurse, int day, double value){
+      const int nbRest = nbRestGains_[nurse][day], nbWork = nbWorkGains_[nurse][day];
+      double restGain = nbRest ? (1 - value) * restGains_[nurse][day] / nbRest : 0;
+      double workGain = nbWork ? value * workGains_[nurse][day] / nbWork : 0;
+      return max(restGain, EPSILON) * max(workGain, EPSILON);
+   }
+
+protected:
+   vector<vector<double> > restGains_, workGains_;
+   vector<vector<int> > nbEvaluations_, nbRestGains_, nbWorkGains_;
+};
+
 class DiveBranchingRule: public MyBranchingRule
 {
 public:
@@ -82,9 +195,26 @@ public:
    /* branch on a set of resting arcs */
    void branchOnRestingArcs(vector<MyVar*>& branchingCandidates);
 
+   /* choose the set of resting arcs with strong branching and pseudo-costs */
+   pair<LiveNurse*, int> strongBranchOnRestingArcs();
+
    /* compute fixing decisions */
    void logical_fixing(vector<MyVar*>& fixingCandidates);
 
+   /* current resting arcs of a nurse on a day */
+   void getRestVars(LiveNurse* pNurse, int day, vector<MyVar*>& restVars){
+      restVars = master_->getRestsPerDay(pNurse)[day];
+   }
+
+   /* new branching rule with the same search strategy */
+   MyBranchingRule* clone(){
+      DiveBranchingRule* pRule = new DiveBranchingRule(master_, name_);
+      pRule->set_search_strategy(searchStrategy_);
+      //the pseudo-costs are shared by all the branching rules of the tree
+      pRule->pPseudoCosts_ = pPseudoCosts_;
+      return pRule;
+   }
+
    /* compare columns */
    static bool compareColumnCloseToInt(pair<MyVar*, double> obj1, pair<MyVar*, double> obj2);
 
@@ -106,12 +236,16 @@ protected:
    //vectors of the variables on which we can branch
    //
    vector<MyVar*> bestCandidates_, mediumCandidates_;
+
+   //pseudo-costs of the rest decisions (protected by the lock of the model)
+   //
+   shared_ptr<RestPseudoCosts> pPseudoCosts_;
 };
 
 class CorePriorityBranchingRule: public MyBranchingRule
 {
 public:
-   CorePriorityBranchingRule(Modeler* pModel, const char* name);
+   CorePriorityBranchingRule(MasterProblem* master, const char* name);
    virtual ~CorePriorityBranchingRule() { }
 
    /* compute branching decisions */
@@ -123,6 +257,7 @@ public:
 protected:
    //pointers to the data
    //
+   MasterProblem* master_;
    Modeler* pModel_;
 };
 
@@ -62,7 +62,7 @@ LiveNurse::LiveNurse(const Nurse& nurse, Scenario* pScenario, int nbDays, int fi
 State* pStateIni,	map<int,set<int> >* pWishesOff):
 Nurse(nurse.id_, nurse.name_, nurse.nbSkills_, nurse.skills_, nurse.pContract_),
 pScenario_(pScenario), nbDays_(nbDays), firstDay_(firstDay),
-pStateIni_(pStateIni), pWishesOff_(pWishesOff), pPosition_(0),
+pStateIni_(pStateIni), pWishesOff_(pWishesOff), pPosition_(0), multiplicity_(1),
 minWorkDaysNoPenaltyConsDays_(-1), maxWorkDaysNoPenaltyConsDays_(-1),
 minWorkDaysNoPenaltyTotalDays_(-1), maxWorkDaysNoPenaltyTotalDays_(-1),
 minAvgWorkDaysNoPenaltyTotalDays_(-1), maxAvgWorkDaysNoPenaltyTotalDays_(-1) {
@@ -14,6 +14,8 @@
 #include "Scenario.h"
 #include "SolverInput.h"
 
+#include <mutex>
+
 //-----------------------------------------------------------------------------
 //
 //  C l a s s   S t a t N u r s e C t
@@ -173,6 +175,12 @@ public:
    //
    Position* pPosition_;
 
+   // number of nurses represented by this nurse when the identical nurses are
+   // aggregated in the master problem: 0 if the nurse is represented by
+   // another one, 1 if it is not aggregated
+   //
+   int multiplicity_;
+
    //----------------------------------------------------------------------------
    // Informative data
    //----------------------------------------------------------------------------
@@ -296,6 +304,52 @@ struct PrintSolution{
    virtual void save(vector<int>& weekIndices, string outdir) = 0;
 };
 
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   S h a r e d I n c u m b e n t
+//    Best upper bound shared by several solvers running in parallel on the
+//    same problem (portfolio): each solver prunes its tree with it, and all of
+//    them stop as soon as one has closed the gap
+//
+//-----------------------------------------------------------------------------
+class SharedIncumbent{
+public:
+   SharedIncumbent(): bestUB_(LARGE_SCORE), stopped_(false) {}
+
+   double getBestUB() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return bestUB_;
+   }
+
+   //update the best upper bound if ub improves it, and then save the solution if pSaveFunction is given.
+   //The solution is saved under the lock, so that the last solution saved is always the best one.
+   bool update(double ub, PrintSolution* pSaveFunction, vector<int>& weekIndices, string outdir) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if(ub > bestUB_ - EPSILON)
+         return false;
+      bestUB_ = ub;
+      if(pSaveFunction)
+         pSaveFunction->save(weekIndices, outdir);
+      return true;
+   }
+
+   //a solver has closed the gap: the others must stop
+   void stop() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+   }
+
+   bool isStopped() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return stopped_;
+   }
+
+private:
+   std::mutex mutex_;
+   double bestUB_;
+   bool stopped_;
+};
+
 //-----------------------------------------------------------------------------
 //
 //  C l a s s   S o l v e r P a r a m
@@ -338,10 +392,58 @@ public:
 	//if 0, the algorithm computes the relaxation if the algorithm is a column generation procedure
 	int stopAfterXSolution_ = 9999999;
 
+	//time limit in s of each run of the restricted master MIP heuristic (BCP with Cbc); 0 disables it
+	double mipHeuristicTime_ = 10;
+
+	//strong branching on the rests (S_CLP only, the other solvers ignore it): number of candidates whose children are evaluated
+	//in parallel with at most strongBranchingIterations_ iterations of column generation; 0 disables it
+	int strongBranchingSize_ = 0;
+	int strongBranchingIterations_ = 5;
+
+	//generate the long resting arcs of the rotation network as columns instead of creating them all in the core
+	bool lazyLongRests_ = true;
+
+	//aggregate the identical nurses (same contract, position, initial state and wishes) in one block of the master problem;
+	//only the nurses whose total numbers of worked days and weekends cannot be penalized are aggregated, so that the master stays exact
+	bool aggregateNurses_ = false;
+
+	//when the gap of the root (BCP with Cbc) is smaller than enumerationGap_, enumerate all the columns whose reduced cost
+	//is within the gap and solve the restricted master as a MIP, unless there are more than enumerationMaxColumns_; 0 disables it
+	double enumerationGap_ = 0;
+	int enumerationMaxColumns_ = 200000;
+
+	//maximal number of subgradient iterations of the Lagrangian bound (LAGRANGIAN evaluation algorithm)
+	int lagrangianIterations_ = 50;
+
+	//stop as soon as the lower bound exceeds cutOff_: the returned cost is then larger than cutOff_,
+	//but it is only a lower bound of the cost of the complete solve
+	double cutOff_ = LARGE_SCORE;
+
 	//primal-dual strategy
 	WeightStrategy weightStrategy_ =  NO_STRAT;
 
 	int verbose_ = 1;
+
+	//store the names of the variables and constraints of the model;
+	//if false, they only carry an id and their names are generated on demand
+	bool storeNames_ = false;
+
+	//number of threads used by the branch and price (S_CLP); 0 means one per core
+	int nbThreads_ = 1;
+
+	//number of threads solving the sub problems in the background with the last duals while the LP is re-solved (S_BCP);
+	//0 keeps the synchronous pricing
+	int nbPricingThreads_ = 0;
+
+	//number of solvers with different search strategies run in parallel by the
+	//deterministic tests (portfolio); 0 means one per core
+	int portfolioSize_ = 1;
+
+	//if positive, seed used to shuffle the order in which the pricer solves the sub problems
+	int pricerSeed_ = 0;
+
+	//incumbent shared with the other solvers of a portfolio (0 if solved alone)
+	SharedIncumbent* pSharedIncumbent_ = 0;
 };
 
 
@@ -354,7 +456,7 @@ public:
 //
 //-----------------------------------------------------------------------------
 
-enum Algorithm{GREEDY, GENCOL, STOCHASTIC_GREEDY, STOCHASTIC_GENCOL, NONE};
+enum Algorithm{GREEDY, GENCOL, STOCHASTIC_GREEDY, STOCHASTIC_GENCOL, LAGRANGIAN, NONE};
 enum Status{UNSOLVED,FEASIBLE,INFEASIBLE,OPTIMAL};
 
 class Solver{
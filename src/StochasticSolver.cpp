@@ -9,6 +9,7 @@
 #include "DemandGenerator.h"
 #include "Greedy.h"
 #include "MasterProblem.h"
+#include "LagrangianSolver.h"
 
 // #define COMPARE_EVALUATIONS
 
@@ -32,6 +33,8 @@ options_(options), demandHistory_(demandHistory), pReusableGenerationSolver_(0),
 	if(options_.generationParameters_.maxSolvingTimeSeconds_ > options_.totalTimeLimitSeconds_)
 		options_.generationParameters_.maxSolvingTimeSeconds_ = options_.totalTimeLimitSeconds_;
 	options_.generationParameters_.weekIndices_ = { pScenario_->thisWeek() };
+	maxGenerationTimeSeconds_ = options_.generationParameters_.maxSolvingTimeSeconds_;
+	maxEvaluationTimeSeconds_ = options_.evaluationParameters_.maxSolvingTimeSeconds_;
 
 	options.generationParameters_.verbose_ = options.verbose_;
 	options.evaluationParameters_.verbose_ = options.verbose_;
@@ -40,11 +43,17 @@ options_(options), demandHistory_(demandHistory), pReusableGenerationSolver_(0),
 	bestSchedule_ = -1;
 	nGenerationDemands_ = 0;
 	nSchedules_ = 0;
+	nSchedulesStarted_ = 0;
+	nGenerationWorkers_ = 0;
+	pPreScreenScenario_ = 0;
+	nGenerationWorkersDone_ = 0;
+	stopGeneration_ = false;
 
 	pEmptyPreferencesForEvaluation_ = new Preferences(pScenario_->nbNurses(), options_.nDaysEvaluation_, pScenario_->nbShifts());
 
 	// create the timer that records the life time of the solver and start it
-	timerTotal_ = new Tools::Timer();
+	// (the cpu time of the process is consumed by all the generation and evaluation threads)
+	timerTotal_ = new Tools::Timer(isWallClockTime());
     timerTotal_->init();
     timerTotal_->start();
 
@@ -63,6 +72,9 @@ options_(options), demandHistory_(demandHistory), pReusableGenerationSolver_(0),
 }
 
 StochasticSolver::~StochasticSolver(){
+	// stop the generation workers if the solve has been interrupted
+	stopGenerationWorkers();
+
 	// kill the timer and display the total time spent in the algorithm
 	timerTotal_->stop();
 	(*pLogStream_) << "Total time spent in the algorithm : " << timerTotal_->dSinceInit() << endl;
@@ -83,6 +95,12 @@ StochasticSolver::~StochasticSolver(){
 		pEvaluationDemands_.pop_back();
 	}
 
+	// delete the pools of rotations of the evaluation demands
+	while (!evaluationRotationPools_.empty()) {
+		delete evaluationRotationPools_.back();
+		evaluationRotationPools_.pop_back();
+	}
+
 	// delete the solvers used for generation
 	while (!pGenerationSolvers_.empty()) {
 		if (pGenerationSolvers_.back()) delete pGenerationSolvers_.back();
@@ -204,14 +222,22 @@ void StochasticSolver::solveOneWeekWithoutPenalties(){
 // Solves the problem by generation + evaluation of scenarios
 void StochasticSolver::solveOneWeekGenerationEvaluation(){
 
+	// The schedules are generated in the background by the workers
+	if(isGenerationPipelined())
+		startGenerationWorkers();
+
 	while(nSchedules_<options_.nGenerationDemandsMax_){
 
 		// get the time left to solve another schedule
 		double timeLeft = options_.totalTimeLimitSeconds_ - timerTotal_->dSinceInit();
 		if (nSchedules_ > 0) {
 			if (timeLeft < 1.0) break;
-//			options_.generationParameters_.maxSolvingTimeSeconds_  = (timeLeft-1.0)/2.0;
-//			options_.evaluationParameters_.maxSolvingTimeSeconds_  = (timeLeft-1.0)/(2.0*options_.nEvaluationDemands_);
+			// no need to start building a schedule if there is a risk that we won't
+			// have any time left to evaluate it
+			if (options_.withAdaptiveTimeBudget_ && !isTimeForAnotherSchedule()) {
+				(*pLogStream_) << "# Not enough time left for another schedule." << std::endl;
+				break;
+			}
 		}
 		(*pLogStream_) << "# Time left: " << timeLeft << std::endl;
 
@@ -264,18 +290,14 @@ void StochasticSolver::solveOneWeekGenerationEvaluation(){
 			}
 		} else {
 			(*pLogStream_) << "# Time has run out." << std::endl;
+			options_.generationParameters_.printEverySolution_ = printOption;
+			break;
 		}
 
 		options_.generationParameters_.printEverySolution_ = printOption;
-
-		// Stop if the average time per schedule is smaller than the time left
-		// no need to start building a schedule if there a risk that we won't
-		// have any time left to evaluate it
-//		timeLeft = options_.totalTimeLimitSeconds_-timerTotal_->dSinceInit();
-//		double avgTimePerSchedule = timerTotal_->dSinceInit()/nSchedules_;
-//		if (timeLeft < avgTimePerSchedule) break;
-
 	}
+	stopGenerationWorkers();
+
 	#ifdef COMPARE_EVALUATIONS
 	for(int i=0; i<nSchedules_; i++){
 		(*pLogStream_) << " The score of schedule " << i << ". GENCOL : " << theScores_[i] << " ; GREEDY : " << theScoresGreedy_[i] << std::endl;
@@ -373,13 +395,86 @@ void StochasticSolver::solveIterativelyWithIncreasingDemand() {
 
 // Do everything for the new schedule (incl. generation, score, ranking)
 bool StochasticSolver::addAndSolveNewSchedule(){
-	generateNewSchedule();
+	Tools::Timer timer(isWallClockTime());
+	timer.init();
+	timer.start();
+
+	// In the pipeline, wait for the next schedule of the workers
+	if(isGenerationPipelined()){
+		// the workers read the generation time limit when they start a schedule
+		if(options_.withAdaptiveTimeBudget_){
+			std::lock_guard<std::mutex> lock(generationMutex_);
+			setGenerationTimeLimit();
+		}
+		if(!takeGeneratedSchedule())
+			return false;
+		// as the first schedule of the sequential generation, write it right away so that a solution is available
+		if(nSchedules_ == 1){
+			loadSolution(schedules_[0]);
+			Tools::LogOutput outStream(options_.generationParameters_.outfile_);
+			outStream << solutionToString();
+		}
+	}
+	else {
+		if(options_.withAdaptiveTimeBudget_)
+			setGenerationTimeLimit();
+		generateNewSchedule();
+	}
+	generationTimes_.push_back(timer.dSinceStart());
 
 //	cout << pReusableGenerationSolver_->solutionToLogString() << endl;
 
 	if(nSchedules_ == 1)
 		generateAllEvaluationDemands();
-	return evaluateSchedule(nSchedules_-1) ;
+
+	timer.init();
+	timer.start();
+	bool isEvaluated = evaluateSchedule(nSchedules_-1);
+	evaluationTimes_.push_back(timer.dSinceStart());
+	(*pLogStream_) << "# Schedule no. " << (nSchedules_-1) << " generated in " << generationTimes_.back() << "s and evaluated in " << evaluationTimes_.back() << "s" << std::endl;
+
+	return isEvaluated;
+}
+
+
+
+//----------------------------------------------------------------------------
+//
+// TIME BUDGET
+//
+//----------------------------------------------------------------------------
+
+static double meanTime(const vector<double>& times){
+	double sum = 0;
+	for(double t: times)
+		sum += t;
+	return times.empty() ? 0 : sum/times.size();
+}
+
+// Time left before the total time limit minus the safety margin
+double StochasticSolver::availableTime(){
+	return options_.totalTimeLimitSeconds_ - timerTotal_->dSinceInit() - options_.timeBudgetMarginSeconds_;
+}
+
+// Return true if the expected generation and evaluation times of a new schedule fit in the available time
+bool StochasticSolver::isTimeForAnotherSchedule(){
+	if(generationTimes_.empty() || evaluationTimes_.empty())
+		return true;
+	double expectedTime = meanTime(generationTimes_) + meanTime(evaluationTimes_);
+	(*pLogStream_) << "# Expected time for a new schedule: " << expectedTime << "s (available: " << availableTime() << "s)" << std::endl;
+	return expectedTime <= availableTime();
+}
+
+// Set the time limit of the generation so that the expected evaluation time remains available
+void StochasticSolver::setGenerationTimeLimit(){
+	double timeLimit = std::min(maxGenerationTimeSeconds_, availableTime() - meanTime(evaluationTimes_));
+	options_.generationParameters_.maxSolvingTimeSeconds_ = std::max(timeLimit, 0.0);
+}
+
+// Share the available time between the nSolves evaluation solves left for the schedule
+void StochasticSolver::setEvaluationTimeLimit(int nSolves){
+	double timeLimit = std::min(maxEvaluationTimeSeconds_, availableTime()/std::max(nSolves, 1));
+	options_.evaluationParameters_.maxSolvingTimeSeconds_ = std::max(timeLimit, 0.0);
 }
 
 
@@ -394,29 +489,35 @@ bool StochasticSolver::addAndSolveNewSchedule(){
 // Generate a new demand for generation
 void StochasticSolver::generateSingleGenerationDemand(){
 
+	(*pLogStream_) << "# Generating new generation demand..." << std::endl;
+
+	pGenerationDemands_.push_back( generateGenerationDemand(pScenario_) );
+	nGenerationDemands_ ++;
+	(*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Generation demand no. " << (nGenerationDemands_-1) << " created (over " << pGenerationDemands_[nGenerationDemands_-1]->nbDays_ << " days)." << std::endl;
+}
+
+
+
+// Generate a new demand for generation on the scenario pScen, without storing it
+// (nothing is logged, as it may be called by the generation workers)
+Demand* StochasticSolver::generateGenerationDemand(Scenario* pScen){
+
 	int nDaysInDemand = options_.nExtraDaysGenerationDemands_;
 	bool isFeasible = false;
 	Demand * pCompleteDemand;
 	Demand * pSingleDemand;
 
-	(*pLogStream_) << "# Generating new generation demand..." << std::endl;
-
 	while(!isFeasible){
-		DemandGenerator dg (1, nDaysInDemand, demandHistory_ , pScenario_);
+		DemandGenerator dg (1, nDaysInDemand, demandHistory_ , pScen);
 		pSingleDemand = dg.generateSinglePerturbatedDemand(false); // no feasibility check here
-		pCompleteDemand = pScenario_->pWeekDemand()->append(pSingleDemand);
+		pCompleteDemand = pScen->pWeekDemand()->append(pSingleDemand);
 		isFeasible = dg.checkDemandFeasibility(pCompleteDemand);
-		if(!isFeasible){
-			(*pLogStream_) << "# Demand has been deleted because it was infeasible." << std::endl;
+		if(!isFeasible)
 			delete pCompleteDemand;
-			delete pSingleDemand;
-		}
+		delete pSingleDemand;
 	}
 
-	pGenerationDemands_.push_back( pCompleteDemand );
-	nGenerationDemands_ ++;
-	delete pSingleDemand;
-	(*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Generation demand no. " << (nGenerationDemands_-1) << " created (over " << pGenerationDemands_[nGenerationDemands_-1]->nbDays_ << " days)." << std::endl;
+	return pCompleteDemand;
 }
 
 
@@ -431,6 +532,10 @@ void StochasticSolver::generateSingleGenerationDemand(){
 void StochasticSolver::generateAllEvaluationDemands(){
 	DemandGenerator dg (options_.nEvaluationDemands_, options_.nDaysEvaluation_, demandHistory_, pScenario_);
 	pEvaluationDemands_ = dg.generatePerturbedDemands();
+	// One pool of rotations per evaluation demand, shared by the evaluations of all the schedules
+	if(options_.evaluationRotationPoolSize_ > 0)
+		for(int j=0; j<options_.nEvaluationDemands_; j++)
+			evaluationRotationPools_.push_back(new RotationPool(options_.evaluationRotationPoolSize_));
 	// Initialize structures for scores
 	for(int j=0; j<options_.nEvaluationDemands_; j++){
 		map<double, set<int> > m;
@@ -456,14 +561,15 @@ void StochasticSolver::generateAllEvaluationDemands(){
 //----------------------------------------------------------------------------
 
 // Return a solver with the algorithm specified for schedule GENERATION
-Solver* StochasticSolver::setGenerationSolverWithInputAlgorithm(Demand* pDemand){
+Solver* StochasticSolver::setGenerationSolverWithInputAlgorithm(Demand* pDemand, Scenario* pScen, MySolverType solverType){
 	Solver* pSolver;
+	if(!pScen) pScen = pScenario_;
 	switch(options_.generationAlgorithm_){
 	case GREEDY:
-		pSolver = new Greedy(pScenario_, pDemand, pScenario_->pWeekPreferences(), pScenario_->pInitialState());
+		pSolver = new Greedy(pScen, pDemand, pScen->pWeekPreferences(), pScen->pInitialState());
 		break;
 	case GENCOL:
-		pSolver = new MasterProblem(pScenario_, pDemand, pScenario_->pWeekPreferences(), pScenario_->pInitialState(), S_BCP);
+		pSolver = new MasterProblem(pScen, pDemand, pScen->pWeekPreferences(), pScen->pInitialState(), solverType);
 		break;
 	default:
 		Tools::throwError("The algorithm is not handled yet");
@@ -488,7 +594,9 @@ void StochasticSolver::generateNewSchedule(){
 		// Create a new solver if first schedule or if RE-solve is forbidden
 		if(nSchedules_ == 0 or !(options_.withResolveForGeneration_) ){
 			if(nSchedules_ > 0) delete pReusableGenerationSolver_;
-			pReusableGenerationSolver_ = setGenerationSolverWithInputAlgorithm( newDemand );
+			// the multi-threaded branch-and-price is used if several threads are given (nbThreads in the generation options)
+			MySolverType solverType = (options_.generationParameters_.nbThreads_ != 1) ? S_CLP : S_BCP;
+			pReusableGenerationSolver_ = setGenerationSolverWithInputAlgorithm( newDemand, 0, solverType );
 		}
 
 		if(options_.generationCostPerturbation_){
@@ -514,16 +622,154 @@ void StochasticSolver::generateNewSchedule(){
 
 	// C. Store the solution
 	//
-	schedules_.push_back(pReusableGenerationSolver_->getSolutionAtDay(6));
-	finalStates_.push_back(pReusableGenerationSolver_->getStatesOfDay(6));
+	storeNewSchedule(pReusableGenerationSolver_->getSolutionAtDay(6), pReusableGenerationSolver_->getStatesOfDay(6),
+		pReusableGenerationSolver_->solutionCost(7), pReusableGenerationSolver_->getNbDays());
+}
+
+// Store a new schedule with its final states and its base cost
+void StochasticSolver::storeNewSchedule(const vector<Roster>& schedule, const vector<State>& finalStates, int baseCost, int nbDays){
+
+	schedules_.push_back(schedule);
+	finalStates_.push_back(finalStates);
+	theBaseCosts_.push_back(baseCost);
 
-	// D. Update the data
+	// Update the data
 	//
 	nSchedules_ ++;
 
-	// E. Display
+	// Display
 	//
-	(*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Candidate schedule no. " << (nSchedules_-1) << " generated: (length: " << pReusableGenerationSolver_->getNbDays() << " days)" << std::endl;
+	(*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Candidate schedule no. " << (nSchedules_-1) << " generated: (length: " << nbDays << " days)" << std::endl;
+}
+
+
+
+//----------------------------------------------------------------------------
+//
+// PIPELINED GENERATION OF SCHEDULES
+//
+//----------------------------------------------------------------------------
+
+void StochasticSolver::startGenerationWorkers(){
+	// the workers do not write the solutions: the main thread writes the best evaluated schedule
+	SolverParam param = options_.generationParameters_;
+	param.printEverySolution_ = false;
+	param.nbThreads_ = 1;
+
+	nGenerationWorkers_ = std::max(1, options_.nGenerationThreads_);
+	for(int t=0; t<nGenerationWorkers_; ++t)
+		generationWorkers_.push_back(std::thread(&StochasticSolver::runGenerationWorker, this, param));
+}
+
+void StochasticSolver::stopGenerationWorkers(){
+	{
+		std::lock_guard<std::mutex> lock(generationMutex_);
+		stopGeneration_ = true;
+		for(SharedIncumbent* pIncumbent: generationIncumbents_)
+			pIncumbent->stop();
+		scheduleTaken_.notify_all();
+	}
+	for(std::thread& worker: generationWorkers_)
+		worker.join();
+	generationWorkers_.clear();
+}
+
+void StochasticSolver::runGenerationWorker(SolverParam param){
+	// Own copy of the scenario with its own demand: as the scenarios of the evaluation solvers,
+	// it shares the contracts and the positions of pScenario_, so it is not deleted
+	Scenario* pScen = new Scenario(*pScenario_);
+	pScen->linkWithDemand(new Demand(*pScenario_->pWeekDemand()));
+	pScen->pWeekDemand()->initializeRdmGenerator();
+
+	SharedIncumbent incumbent;
+	param.pSharedIncumbent_ = &incumbent;
+	{
+		std::lock_guard<std::mutex> lock(generationMutex_);
+		generationIncumbents_.push_back(&incumbent);
+	}
+
+	try{
+		while(true){
+			{
+				// the schedules are not generated faster than they are evaluated
+				std::unique_lock<std::mutex> lock(generationMutex_);
+				scheduleTaken_.wait(lock, [this](){
+					return stopGeneration_ || generatedSchedules_.size() < nGenerationWorkers_; });
+				if(stopGeneration_ || nSchedulesStarted_ >= options_.nGenerationDemandsMax_)
+					break;
+				++nSchedulesStarted_;
+				// time limit adapted by the main thread (withAdaptiveTimeBudget_)
+				if(options_.withAdaptiveTimeBudget_)
+					param.maxSolvingTimeSeconds_ = options_.generationParameters_.maxSolvingTimeSeconds_;
+			}
+			// the solve (S_CLP) stops at the total time limit
+			double timeLeft = options_.totalTimeLimitSeconds_ - timerTotal_->dSinceInit();
+			if(timeLeft < 1.0)
+				break;
+			SolverParam solveParam = param;
+			solveParam.maxSolvingTimeSeconds_ = std::min(param.maxSolvingTimeSeconds_, timeLeft - 1.0);
+
+			// Generate a demand and solve it: the demand, the solver and their random generators belong to the worker
+			Demand* pDemand = generateGenerationDemand(pScen);
+			Solver* pSolver = setGenerationSolverWithInputAlgorithm(pDemand, pScen, S_CLP);
+			if(options_.generationCostPerturbation_)
+				pSolver->setBoundsAndWeights(param.weightStrategy_);
+			pSolver->solve(solveParam);
+
+			std::lock_guard<std::mutex> lock(generationMutex_);
+			// the solve may have been interrupted by stopGenerationWorkers
+			if(stopGeneration_){
+				delete pSolver;
+				delete pDemand;
+				break;
+			}
+			if(pSolver->getStatus() == FEASIBLE or pSolver->getStatus() == OPTIMAL){
+				GeneratedSchedule generated;
+				generated.schedule_ = pSolver->getSolutionAtDay(6);
+				generated.finalStates_ = pSolver->getStatesOfDay(6);
+				generated.baseCost_ = pSolver->solutionCost(7);
+				generated.nbDays_ = pSolver->getNbDays();
+				generatedSchedules_.push_back(generated);
+				scheduleGenerated_.notify_all();
+			}
+			// try again with another demand
+			else
+				--nSchedulesStarted_;
+
+			delete pSolver;
+			delete pDemand;
+		}
+	}
+	catch(...){
+		std::lock_guard<std::mutex> lock(generationMutex_);
+		if(!generationException_)
+			generationException_ = std::current_exception();
+	}
+
+	delete pScen->pWeekDemand();
+
+	std::lock_guard<std::mutex> lock(generationMutex_);
+	generationIncumbents_.erase(std::find(generationIncumbents_.begin(), generationIncumbents_.end(), &incumbent));
+	++nGenerationWorkersDone_;
+	scheduleGenerated_.notify_all();
+}
+
+bool StochasticSolver::takeGeneratedSchedule(){
+	std::unique_lock<std::mutex> lock(generationMutex_);
+	scheduleGenerated_.wait(lock, [this](){ return !generatedSchedules_.empty() || generationException_
+		|| nGenerationWorkersDone_ == nGenerationWorkers_; });
+	if(generationException_)
+		std::rethrow_exception(generationException_);
+	if(generatedSchedules_.empty())
+		return false;
+
+	GeneratedSchedule generated = generatedSchedules_.front();
+	generatedSchedules_.pop_front();
+	scheduleTaken_.notify_all();
+	lock.unlock();
+
+	storeNewSchedule(generated.schedule_, generated.finalStates_, generated.baseCost_, generated.nbDays_);
+	return true;
 }
 
 
@@ -535,7 +781,7 @@ void StochasticSolver::generateNewSchedule(){
 //----------------------------------------------------------------------------
 
 // Return a solver with the algorithm specified for schedule EVALUATION
-Solver* StochasticSolver::setEvaluationWithInputAlgorithm(Demand* pDemand, vector<State> * stateEndOfSchedule){
+Solver* StochasticSolver::setEvaluationWithInputAlgorithm(Demand* pDemand, vector<State> * stateEndOfSchedule, MySolverType solverType){
 	Solver* pSolver;
 	Scenario * pScen = new Scenario (*pScenario_);
 	pScen->linkWithDemand(new Demand ());
@@ -548,7 +794,10 @@ Solver* StochasticSolver::setEvaluationWithInputAlgorithm(Demand* pDemand, vecto
 		pSolver = new Greedy(pScen, pDemand, pEmptyPreferencesForEvaluation_, stateEndOfSchedule);
 		break;
 	case GENCOL:
-		pSolver = new MasterProblem(pScen, pDemand, pEmptyPreferencesForEvaluation_, stateEndOfSchedule, S_BCP);
+		pSolver = new MasterProblem(pScen, pDemand, pEmptyPreferencesForEvaluation_, stateEndOfSchedule, solverType);
+		break;
+	case LAGRANGIAN:
+		pSolver = new LagrangianSolver(pScen, pDemand, pEmptyPreferencesForEvaluation_, stateEndOfSchedule);
 		break;
 	default:
 		Tools::throwError("The algorithm is not handled yet");
@@ -557,6 +806,15 @@ Solver* StochasticSolver::setEvaluationWithInputAlgorithm(Demand* pDemand, vecto
 	return pSolver;
 }
 
+// Share the pool of rotations of the evaluation demand j with the solver (column generation only)
+void StochasticSolver::setEvaluationRotationPool(Solver* pSolver, int j){
+	if(evaluationRotationPools_.empty())
+		return;
+	MasterProblem* pMaster = dynamic_cast<MasterProblem*>(pSolver);
+	if(pMaster)
+		pMaster->setRotationPool(evaluationRotationPools_[j]);
+}
+
 // Initialization
 void StochasticSolver::initScheduleEvaluation(int sched){
 	// Extend pEvaluationSolvers_
@@ -573,6 +831,15 @@ void StochasticSolver::initScheduleEvaluation(int sched){
 // Evaluate 1 schedule on all evaluation instances
 bool StochasticSolver::evaluateSchedule(int sched){
 
+	if(options_.withEvaluationCache_ && evaluateScheduleFromCache(sched))
+		return true;
+
+	if(options_.withGreedyPreScreen_ && !preScreenSchedule(sched))
+		return true;
+
+	if(options_.nEvaluationThreads_ > 1)
+		return evaluateScheduleInParallel(sched);
+
 	(*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Evaluation of the schedule no. " << sched << std::endl;
 
 	#ifdef COMPARE_EVALUATIONS
@@ -584,18 +851,17 @@ bool StochasticSolver::evaluateSchedule(int sched){
 	#endif
 
 	initScheduleEvaluation(sched);
-	vector<State> initialStates = finalStates_[nSchedules_-1];
+	vector<State> initialStates = finalStates_[sched];
 	for (int i = 0; i < pScenario_->nbNurses_; i++) {
 		initialStates[i].dayId_ = 0;
 	}
 
-	int baseCost = pReusableGenerationSolver_->solutionCost(7);
-	theBaseCosts_.push_back(baseCost);
-
-	// set the time per evaluation to the ratio of the time left over the number of evaluations
-	// double timeLeft = options_.totalTimeLimitSeconds_-timerTotal_->dSinceInit();
-	// options_.evaluationParameters_.maxSolvingTimeSeconds_ = (timeLeft-1.0)/(double)options_.nEvaluationDemands_;
+	int baseCost = theBaseCosts_[sched];
 
+	// costs of the evaluation demands without the base cost (empty if one of them has not been evaluated)
+	vector<double> evaluationCosts;
+	// true if the schedule has lost its race against the best schedule or cannot beat it anymore
+	bool isDropped = false;
 
 	for(int j=0; j<options_.nEvaluationDemands_; j++){
 
@@ -603,6 +869,24 @@ bool StochasticSolver::evaluateSchedule(int sched){
 		if (nSchedules_ > 0 && timeLeft < 1.0){
 			// insert solution with a high cost and continue
 			insertSolution(sched, j);
+			evaluationCosts.clear();
+			continue;
+		}
+
+		if(!isDropped && isDominatedInRace(sched, j)){
+			(*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Schedule no. " << sched << " is dominated by the best schedule after " << j << " evaluation demands: its evaluation stops." << std::endl;
+			isDropped = true;
+		}
+		SolverParam param = options_.evaluationParameters_;
+		param.cutOff_ = evaluationCutOff(sched, j);
+		if(!isDropped && param.cutOff_ < 0){
+			(*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Schedule no. " << sched << " cannot beat the best schedule after " << j << " evaluation demands: its evaluation stops." << std::endl;
+			isDropped = true;
+		}
+		if(isDropped){
+			// insert solution with a high cost and continue
+			insertSolution(sched, j);
+			evaluationCosts.clear();
 			continue;
 		}
 
@@ -636,27 +920,34 @@ bool StochasticSolver::evaluateSchedule(int sched){
 //			isTimeForMoreThanOneSchedule = false;
 //		}
 
-		// Only perform the evaluation if the schedule is feasible and
-		// there is time for more than one schedule
+		// The schedule is feasible: only the feasible schedules are stored by the generation
 		double currentCost = costPreviousWeeks_ + baseCost, currentCostGreedy = costPreviousWeeks_ + baseCost;
-		if (pReusableGenerationSolver_->getStatus() == INFEASIBLE) {
-			currentCost = 1.0e6;
-			currentCostGreedy = 1.0e6;
-		}
-		else {
-			// Perform the actual evaluation on demand j by running the chosen algorithm
-			// TODO : ici, arondi a l'entier -> peut etre modifie si besoin
-			if(j==0){
-				currentCost += (int) pReusableEvaluationSolvers_[sched]->solve(options_.evaluationParameters_);
-			} else {
-				currentCost += (int) pReusableEvaluationSolvers_[sched]->resolve(pEvaluationDemands_[j], options_.evaluationParameters_);
-			}
 
-			#ifdef COMPARE_EVALUATIONS
-			pGreedyEvaluators[j]->solve();
-			currentCostGreedy += pGreedyEvaluators[j]->solutionCost();
-			#endif
+		// Perform the actual evaluation on demand j by running the chosen algorithm
+		// TODO : ici, arondi a l'entier -> peut etre modifie si besoin
+		double evaluationCost;
+		setEvaluationRotationPool(pReusableEvaluationSolvers_[sched], j);
+		// set the time per evaluation to the ratio of the time left over the number of evaluations left
+		if(options_.withAdaptiveTimeBudget_){
+			setEvaluationTimeLimit(options_.nEvaluationDemands_ - j);
+			param.maxSolvingTimeSeconds_ = options_.evaluationParameters_.maxSolvingTimeSeconds_;
 		}
+		if(j==0){
+			evaluationCost = (int) pReusableEvaluationSolvers_[sched]->solve(param);
+		} else {
+			evaluationCost = (int) pReusableEvaluationSolvers_[sched]->resolve(pEvaluationDemands_[j], param);
+		}
+		currentCost += evaluationCost;
+		if(evaluationCosts.size() == j)
+			evaluationCosts.push_back(evaluationCost);
+		// the solve may have stopped at its cut-off: the cost is then only a lower bound, which is not cached
+		if(evaluationCost > param.cutOff_)
+			evaluationCosts.clear();
+
+		#ifdef COMPARE_EVALUATIONS
+		pGreedyEvaluators[j]->solve();
+		currentCostGreedy += pGreedyEvaluators[j]->solutionCost();
+		#endif
 
 		// Display
 		//
@@ -667,16 +958,319 @@ bool StochasticSolver::evaluateSchedule(int sched){
 		insertSolution(sched, j, currentCost, currentCostGreedy);
 	}
 
+	storeEvaluation(sched, evaluationCosts);
+
 	(*pLogStream_) << "# Evaluation of schedule no. " << sched << " done!" << std::endl;
 
 	updateRankingsAndScores(options_.rankingStrategy_);
 
+	if(options_.withGreedyPreScreen_)
+		logFidelityCorrelation();
+
 	return true;
 
 }
 
+// Evaluate 1 schedule on all evaluation instances at once, with one solver per evaluation demand
+bool StochasticSolver::evaluateScheduleInParallel(int sched){
+
+	(*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Parallel evaluation of the schedule no. " << sched << std::endl;
+
+	initScheduleEvaluation(sched);
+	vector<State> initialStates = finalStates_[sched];
+	for (int i = 0; i < pScenario_->nbNurses_; i++) {
+		initialStates[i].dayId_ = 0;
+	}
+	int baseCost = theBaseCosts_[sched];
+
+	// Create the solvers in this thread, as they draw their random generators (no solver if time has run out)
+	const int nDemands = options_.nEvaluationDemands_;
+	// each thread solves the evaluation demands one after the other
+	if(options_.withAdaptiveTimeBudget_){
+		int nThreads = std::min(options_.nEvaluationThreads_, nDemands);
+		setEvaluationTimeLimit((nDemands + nThreads - 1) / nThreads);
+	}
+	SolverParam param = options_.evaluationParameters_;
+	param.nbThreads_ = 1;
+	vector<Solver*> solvers(nDemands, 0);
+	for(int j=0; j<nDemands; j++){
+		double timeLeft = options_.totalTimeLimitSeconds_ - timerTotal_->dSinceInit();
+		if (nSchedules_ > 0 && timeLeft < 1.0)
+			continue;
+		solvers[j] = setEvaluationWithInputAlgorithm(pEvaluationDemands_[j], & initialStates, S_CLP);
+		setEvaluationRotationPool(solvers[j], j);
+		if(options_.evaluationCostPerturbation_ && solvers[j]->getNbDays() + (7*pScenario_->thisWeek()+1) < 7* pScenario_->nbWeeks_)
+			solvers[j]->setBoundsAndWeights(options_.evaluationParameters_.weightStrategy_);
+	}
+
+	// Solve them: each thread takes the next evaluation demand until all of them are solved
+	vector<double> costs(nDemands, 0);
+	vector<std::exception_ptr> exceptions(nDemands);
+	std::mutex mutex;
+	int nextDemand = 0;
+	auto evaluate = [&](){
+		while(true){
+			int j;
+			// the solve (S_CLP) stops at the total time limit
+			SolverParam solveParam = param;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				j = nextDemand++;
+				double timeLeft = options_.totalTimeLimitSeconds_ - timerTotal_->dSinceInit();
+				solveParam.maxSolvingTimeSeconds_ = std::min(param.maxSolvingTimeSeconds_, std::max(timeLeft - 1.0, 0.0));
+			}
+			if(j >= nDemands)
+				return;
+			if(!solvers[j])
+				continue;
+			try{
+				costs[j] = solvers[j]->solve(solveParam);
+			}
+			catch(...){
+				exceptions[j] = std::current_exception();
+			}
+		}
+	};
+	vector<std::thread> threads;
+	for(int t=1; t<std::min(options_.nEvaluationThreads_, nDemands); t++)
+		threads.push_back(std::thread(evaluate));
+	evaluate();
+	for(std::thread& th: threads)
+		th.join();
+
+	// Forward the first failure of a solve once all the solvers are deleted
+	for(int j=0; j<nDemands; j++)
+		if(exceptions[j]){
+			for(Solver* pSolver: solvers)
+				delete pSolver;
+			std::rethrow_exception(exceptions[j]);
+		}
+
+	// Insert the solution costs in the order of the evaluation demands
+	vector<double> evaluationCosts;
+	for(int j=0; j<nDemands; j++){
+		if(!solvers[j]){
+			// insert solution with a high cost
+			insertSolution(sched, j);
+			continue;
+		}
+
+		double currentCost = costPreviousWeeks_ + baseCost + (int) costs[j];
+		(*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Schedule no. " << sched << " evaluated over evaluation demand no. " << j << " (solution cost: " << currentCost << ")." << std::endl;
+		insertSolution(sched, j, currentCost);
+		delete solvers[j];
+		if(evaluationCosts.size() == j)
+			evaluationCosts.push_back((int) costs[j]);
+	}
+
+	storeEvaluation(sched, evaluationCosts);
+
+	(*pLogStream_) << "# Evaluation of schedule no. " << sched << " done!" << std::endl;
+
+	updateRankingsAndScores(options_.rankingStrategy_);
+
+	if(options_.withGreedyPreScreen_)
+		logFidelityCorrelation();
+
+	return true;
+}
+
+// Evaluate 1 schedule with the greedy: return false if its score is not among the best preScreenFraction_
+// of the greedy scores of the schedules so far (its evaluation is then complete with high costs)
+bool StochasticSolver::preScreenSchedule(int sched){
+	const int nDemands = options_.nEvaluationDemands_;
+	if(nDemands == 0)
+		return true;
+
+	vector<State> initialStates = finalStates_[sched];
+	for (int i = 0; i < pScenario_->nbNurses_; i++) {
+		initialStates[i].dayId_ = 0;
+	}
+
+	// the scenario of the pre-screen is created once, then only relinked with each evaluation demand
+	if(!pPreScreenScenario_){
+		pPreScreenScenario_ = new Scenario (*pScenario_);
+		pPreScreenScenario_->linkWithDemand(new Demand ());
+		pPreScreenScenario_->updateNewWeek(pEvaluationDemands_[0], *pEmptyPreferencesForEvaluation_, initialStates);
+	}
+
+	double greedyScore = 0;
+	for(int j=0; j<nDemands; j++){
+		pPreScreenScenario_->linkWithDemand(pEvaluationDemands_[j]);
+		pPreScreenScenario_->setInitialState(initialStates);
+
+		Greedy greedy(pPreScreenScenario_, pEvaluationDemands_[j], pEmptyPreferencesForEvaluation_, &initialStates);
+		if(options_.evaluationCostPerturbation_ && greedy.getNbDays() + (7*pScenario_->thisWeek()+1) < 7* pScenario_->nbWeeks_)
+			greedy.computeWeightsTotalShiftsForStochastic();
+		double cost = greedy.solve();
+		greedyScore += ((greedy.getStatus() == INFEASIBLE) ? 1.0e6 : costPreviousWeeks_ + theBaseCosts_[sched] + cost) / nDemands;
+	}
+	if(theGreedyScores_.size() <= sched)
+		theGreedyScores_.resize(sched+1, -1);
+	theGreedyScores_[sched] = greedyScore;
+
+	// rank of the schedule among the pre-screened ones
+	int rank = 0, nScreened = 0;
+	for(double score: theGreedyScores_){
+		if(score < 0) continue;
+		nScreened++;
+		if(score < greedyScore) rank++;
+	}
+	if(rank < std::max(1.0, options_.preScreenFraction_ * nScreened)){
+		(*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Schedule no. " << sched << " passes the greedy pre-screen (greedy score: " << greedyScore << ", rank " << rank+1 << "/" << nScreened << ")." << std::endl;
+		return true;
+	}
+
+	(*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Schedule no. " << sched << " is screened out by the greedy (greedy score: " << greedyScore << ", rank " << rank+1 << "/" << nScreened << ")." << std::endl;
+	initScheduleEvaluation(sched);
+	for(int j=0; j<nDemands; j++)
+		insertSolution(sched, j);
+	updateRankingsAndScores(options_.rankingStrategy_);
+	return false;
+}
+
+// Pearson correlation of two samples of the same size (0 if one of them is constant)
+static double correlation(const vector<double>& x, const vector<double>& y){
+	const int n = x.size();
+	double meanX = 0, meanY = 0;
+	for(int i=0; i<n; i++){
+		meanX += x[i] / n;
+		meanY += y[i] / n;
+	}
+	double covXY = 0, varX = 0, varY = 0;
+	for(int i=0; i<n; i++){
+		covXY += (x[i] - meanX) * (y[i] - meanY);
+		varX += (x[i] - meanX) * (x[i] - meanX);
+		varY += (y[i] - meanY) * (y[i] - meanY);
+	}
+	return (varX > 0 && varY > 0) ? covXY / sqrt(varX * varY) : 0;
+}
+
+// Ranks of a sample (the average rank for the ties)
+static vector<double> ranks(const vector<double>& x){
+	const int n = x.size();
+	vector<double> r(n);
+	for(int i=0; i<n; i++){
+		int nBelow = 0, nEqual = 0;
+		for(int k=0; k<n; k++){
+			if(x[k] < x[i]) nBelow++;
+			else if(x[k] == x[i]) nEqual++;
+		}
+		r[i] = nBelow + (nEqual - 1) / 2.0;
+	}
+	return r;
+}
+
+// Log the correlation between the greedy and the full evaluations of the schedules evaluated by both
+void StochasticSolver::logFidelityCorrelation(){
+	vector<double> greedyScores, fullScores;
+	for(int sched=0; sched<theGreedyScores_.size() && sched<theEvaluationCosts_.size(); sched++){
+		if(theGreedyScores_[sched] < 0 || theGreedyScores_[sched] >= 1.0e6)
+			continue;
+		// skip the schedules screened out or not evaluated over all the demands
+		double fullScore = 0;
+		bool isComplete = true;
+		for(double cost: theEvaluationCosts_[sched]){
+			if(cost >= 1.0e6) isComplete = false;
+			fullScore += cost / options_.nEvaluationDemands_;
+		}
+		if(!isComplete)
+			continue;
+		greedyScores.push_back(theGreedyScores_[sched]);
+		fullScores.push_back(fullScore);
+	}
+	if(greedyScores.size() < 2)
+		return;
+
+	(*pLogStream_) << "# Correlation of the greedy and full evaluations over " << greedyScores.size() << " schedules: "
+		<< "pearson = " << correlation(greedyScores, fullScores)
+		<< " ; spearman = " << correlation(ranks(greedyScores), ranks(fullScores)) << std::endl;
+}
+
+// Return true if the evaluation of sched over the first nDemands evaluation demands is dominated by the best schedule:
+// the mean of the differences of cost minus racingConfidence_ standard errors is positive
+bool StochasticSolver::isDominatedInRace(int sched, int nDemands){
+	if(!options_.withRacing_ || bestSchedule_ < 0 || nDemands < std::max(2, options_.racingMinDemands_))
+		return false;
+
+	vector<double> differences;
+	for(int j=0; j<nDemands; j++){
+		// the best schedule has not been evaluated on all these demands
+		if(theEvaluationCosts_[bestSchedule_][j] >= 1.0e6)
+			return false;
+		differences.push_back(theEvaluationCosts_[sched][j] - theEvaluationCosts_[bestSchedule_][j]);
+	}
+
+	double mean = 0, variance = 0;
+	for(double d: differences)
+		mean += d / nDemands;
+	for(double d: differences)
+		variance += (d - mean) * (d - mean) / (nDemands - 1);
+
+	return mean - options_.racingConfidence_ * sqrt(variance / nDemands) > 0;
+}
+
+// Cost of the evaluation demand j from which sched cannot beat the best schedule anymore: the RK_MEAN score of sched
+// then exceeds the one of the best schedule, as the evaluation costs of the remaining demands are nonnegative
+double StochasticSolver::evaluationCutOff(int sched, int j){
+	if(!options_.withEvaluationCutOff_ || options_.rankingStrategy_ != RK_MEAN || bestSchedule_ < 0)
+		return LARGE_SCORE;
+
+	const int n = options_.nEvaluationDemands_;
+	const double minCost = costPreviousWeeks_ + theBaseCosts_[sched];
+	// lower bound of the score of sched without the demand j
+	double score = (n-j-1) * (int) (minCost/n);
+	for(int k=0; k<j; k++)
+		score += (int) (theEvaluationCosts_[sched][k]/n);
+
+	return (bestScore_ - score + 1) * n - minCost;
+}
+
+// Key of the cache of the evaluations: sorted list of (contract, skills, state) of the nurses
+vector<vector<int> > StochasticSolver::evaluationKey(const vector<State>& states){
+	vector<vector<int> > key;
+	for (int i = 0; i < pScenario_->nbNurses_; i++) {
+		const Nurse& nurse = pScenario_->theNurses_[i];
+		const State& state = states[i];
+		vector<int> nurseKey = {nurse.pContract_->id_, state.totalDaysWorked_, state.totalWeekendsWorked_,
+			state.consDaysWorked_, state.consShifts_, state.consDaysOff_, state.shift_};
+		nurseKey.insert(nurseKey.end(), nurse.skills_.begin(), nurse.skills_.end());
+		key.push_back(nurseKey);
+	}
+	std::sort(key.begin(), key.end());
+	return key;
+}
+
+// Store the costs of a complete evaluation in the cache
+void StochasticSolver::storeEvaluation(int sched, const vector<double>& evaluationCosts){
+	if(options_.withEvaluationCache_ && evaluationCosts.size() == options_.nEvaluationDemands_)
+		evaluationCache_[evaluationKey(finalStates_[sched])] = evaluationCosts;
+}
+
+// Evaluate 1 schedule with the evaluation of identical final states if any
+bool StochasticSolver::evaluateScheduleFromCache(int sched){
+	map<vector<vector<int> >, vector<double> >::iterator it = evaluationCache_.find(evaluationKey(finalStates_[sched]));
+	if(it == evaluationCache_.end())
+		return false;
+
+	(*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Schedule no. " << sched << " has the same final states as an evaluated schedule: its evaluation is reused" << std::endl;
+
+	initScheduleEvaluation(sched);
+	for(int j=0; j<options_.nEvaluationDemands_; j++)
+		insertSolution(sched, j, costPreviousWeeks_ + theBaseCosts_[sched] + it->second[j]);
+
+	updateRankingsAndScores(options_.rankingStrategy_);
+
+	return true;
+}
+
 void StochasticSolver::insertSolution(int sched, int j,
 							double currentCost, double currentCostGreedy){
+	// Store the cost for the racing
+	if(theEvaluationCosts_.size() <= sched)
+		theEvaluationCosts_.resize(sched+1, vector<double>(options_.nEvaluationDemands_, 1.0e6));
+	theEvaluationCosts_[sched][j] = currentCost;
+
 	// If already in the costs -> add it to the set of schedules that found that cost
 	if(schedulesFromObjectiveByEvaluationDemand_[j].find(currentCost) != schedulesFromObjectiveByEvaluationDemand_[j].end()){
 		schedulesFromObjectiveByEvaluationDemand_[j].at(currentCost).insert(sched);
@@ -12,6 +12,12 @@
 #include "Solver.h"
 #include "MasterProblem.h"
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+
 enum RankingStrategy {RK_MEAN, RK_SCORE, RK_NONE};
 
 class StochasticSolverOptions{
@@ -53,6 +59,8 @@ public:
 	// withResolve is useful here, particularly when evaluating with LP lowest bound
 	bool evaluationCostPerturbation_ = true;
 	bool withResolveForEvaluation_ = true;
+	// LAGRANGIAN: lower bound of the master problem by subgradient on its Lagrangian relaxation, without any LP
+	//             (the number of iterations is evaluationParameters_.lagrangianIterations_)
 	Algorithm evaluationAlgorithm_ = GENCOL;
 
 	// Choice of ranking strategy:
@@ -69,6 +77,56 @@ public:
 	int nDaysEvaluation_ = 14;
 	int nGenerationDemandsMax_ = 100;
 
+	// True -> pipeline the generation and the evaluation: the schedules are generated in the background
+	//         and queued, while the main thread evaluates them and updates the ranking
+	bool pipelineGenerationEvaluation_ = false;
+	// Number of threads generating the candidate schedules concurrently (>1 implies the pipeline)
+	// Each thread has its own copy of the scenario and generates with the native branch and price (S_CLP),
+	// as BCP cannot be run in several threads of the same process.
+	// WARNING: with the pipeline, the total time limit is measured in elapsed time instead of cpu time
+	int nGenerationThreads_ = 1;
+
+	// True -> reuse the evaluation of the schedules with the same end-of-week states
+	bool withEvaluationCache_ = true;
+
+	// True -> race each new schedule against the best one: its evaluation stops as soon as, after at least
+	//         racingMinDemands_ evaluation demands, the mean of its differences of cost with the best schedule
+	//         minus racingConfidence_ standard errors is positive. The remaining demands get a high cost.
+	// WARNING: only in the sequential evaluation (nEvaluationThreads_ = 1)
+	bool withRacing_ = false;
+	int racingMinDemands_ = 2;
+	double racingConfidence_ = 1.0;
+
+	// True -> with RK_MEAN, the evaluation of a schedule stops as soon as its score provably exceeds the one of the best
+	//         schedule: each evaluation solve stops when its lower bound exceeds the largest cost that keeps the schedule
+	//         competitive, and the remaining demands get a high cost.
+	// WARNING: only in the sequential evaluation (nEvaluationThreads_ = 1)
+	bool withEvaluationCutOff_ = false;
+
+	// True -> multi-fidelity evaluation: each schedule is first evaluated with the greedy over the evaluation demands,
+	//         and only the schedules whose greedy score is among the best preScreenFraction_ of the greedy scores so far
+	//         are evaluated with evaluationAlgorithm_. The correlation of the two evaluations is logged to tune the fraction.
+	bool withGreedyPreScreen_ = false;
+	double preScreenFraction_ = 0.5;
+
+	// Maximal number of rotations of each contract in the pool of each evaluation demand (0 disables the pools)
+	// The evaluation solvers (GENCOL) of all the schedules share the rotations that do not start on the first day,
+	// as they do not depend on the final states of the schedule: each solver is seeded with the pool of its demand
+	int evaluationRotationPoolSize_ = 0;
+
+	// True -> adaptive time budget: the time limits of the generation and of the evaluation solves are set from the time
+	//         left and from the measured times of the previous schedules, and no new schedule is started if its expected
+	//         generation and evaluation times do not fit before the total time limit minus timeBudgetMarginSeconds_.
+	//         The time limits of generationParameters_ and evaluationParameters_ remain upper bounds.
+	//         With the pipeline, the workers read the adapted generation time limit when they start a schedule.
+	bool withAdaptiveTimeBudget_ = false;
+	double timeBudgetMarginSeconds_ = 1.0;
+
+	// Number of threads evaluating a schedule over the evaluation demands concurrently
+	// If >1, each evaluation demand gets its own solver (S_CLP, for the same reason), so withResolveForEvaluation_ is ignored
+	// WARNING: if >1, the total time limit is measured in elapsed time instead of cpu time
+	int nEvaluationThreads_ = 1;
+
 	string logfile_ = "";
 
 	SolverParam generationParameters_;
@@ -130,6 +188,9 @@ protected:
 	// Log file that can be useful when calling the solver through simulator
 	Tools::LogOutput* pLogStream_;
 
+	// The time is measured in elapsed time as soon as several threads solve at the same time
+	bool isWallClockTime() { return isGenerationPipelined() || options_.nEvaluationThreads_ > 1; }
+
 
 
 	//----------------------------------------------------------------------------
@@ -153,6 +214,28 @@ protected:
 	void solveOneWeekWithoutPenalties();
 
 
+	//----------------------------------------------------------------------------
+	//
+	// TIME BUDGET
+	// The generation and the evaluation of each schedule are timed to set the time limits of the next solves
+	// and to decide whether another schedule fits in the time left (withAdaptiveTimeBudget_)
+	//
+	//----------------------------------------------------------------------------
+
+	// Time limits of the options, that the adaptive time limits never exceed
+	double maxGenerationTimeSeconds_, maxEvaluationTimeSeconds_;
+	// Measured times of the generation (waiting time for the workers in the pipeline) and of the evaluation of each schedule
+	vector<double> generationTimes_, evaluationTimes_;
+	// Time left before the total time limit minus the safety margin
+	double availableTime();
+	// Return true if the expected generation and evaluation times of a new schedule fit in the available time
+	bool isTimeForAnotherSchedule();
+	// Set the time limit of the generation so that the expected evaluation time remains available
+	void setGenerationTimeLimit();
+	// Share the available time between the nSolves evaluation solves left for the schedule
+	void setEvaluationTimeLimit(int nSolves);
+
+
 	//----------------------------------------------------------------------------
 	//
 	// GENERATION OF DEMANDS FOR THE CURRENT WEEK (=FOR SCHEDULE GENERATION)
@@ -201,10 +284,50 @@ protected:
 	vector<vector<Roster> > schedules_;
 	vector<vector<State> > finalStates_;
 
-	// Return a solver with the algorithm specified for schedule GENERATION
-	Solver * setGenerationSolverWithInputAlgorithm(Demand* pDemand);
+	// Return a solver with the algorithm specified for schedule GENERATION (on pScen if not null)
+	Solver * setGenerationSolverWithInputAlgorithm(Demand* pDemand, Scenario* pScen = 0, MySolverType solverType = S_BCP);
+	// Generate a new demand for generation on the scenario pScen, without storing it
+	Demand * generateGenerationDemand(Scenario* pScen);
 	// Generate a new schedule
 	void generateNewSchedule();
+	// Store a new schedule with its final states and its base cost
+	void storeNewSchedule(const vector<Roster>& schedule, const vector<State>& finalStates, int baseCost, int nbDays);
+
+
+
+	//----------------------------------------------------------------------------
+	//
+	// PIPELINED GENERATION OF SCHEDULES
+	// The workers generate schedules in the background and queue them in a queue bounded by the number of
+	// workers, while the main thread evaluates them one by one.
+	//
+	//----------------------------------------------------------------------------
+
+	bool isGenerationPipelined() { return options_.pipelineGenerationEvaluation_ || options_.nGenerationThreads_ > 1; }
+
+	struct GeneratedSchedule{
+		vector<Roster> schedule_;
+		vector<State> finalStates_;
+		int baseCost_, nbDays_;
+	};
+
+	vector<std::thread> generationWorkers_;
+	// protect all the following members, which are shared with the workers
+	std::mutex generationMutex_;
+	std::condition_variable scheduleGenerated_, scheduleTaken_;
+	std::deque<GeneratedSchedule> generatedSchedules_;
+	// nGenerationWorkers_ is also the capacity of the queue: it is set before the workers are started
+	int nGenerationWorkers_, nSchedulesStarted_, nGenerationWorkersDone_;
+	bool stopGeneration_;
+	// incumbent of each worker, only used to interrupt its current solve when the generation stops
+	vector<SharedIncumbent*> generationIncumbents_;
+	std::exception_ptr generationException_;
+
+	void startGenerationWorkers();
+	void stopGenerationWorkers();
+	void runGenerationWorker(SolverParam param);
+	// Wait for a schedule generated by the workers and store it (returns false if no schedule will come)
+	bool takeGeneratedSchedule();
 
 
 
@@ -232,15 +355,46 @@ protected:
 	vector<double> theBaseCosts_;
 
 	// Return a solver with the algorithm specified for schedule EVALUATION
-	Solver * setEvaluationWithInputAlgorithm(Demand* pDemand, vector<State> * stateEndOfSchedule);
+	Solver * setEvaluationWithInputAlgorithm(Demand* pDemand, vector<State> * stateEndOfSchedule, MySolverType solverType = S_BCP);
+	// Pools of rotations of each evaluation demand (empty if evaluationRotationPoolSize_ = 0)
+	vector<RotationPool*> evaluationRotationPools_;
+	// Share the pool of rotations of the evaluation demand j with the solver (column generation only)
+	void setEvaluationRotationPool(Solver* pSolver, int j);
 	// Initialization
 	void initScheduleEvaluation(int sched);
 	// Evaluate 1 schedule and store the corresponding detailed results (returns false if time has run out)
 	bool evaluateSchedule(int sched);
+	// Same, but the evaluation demands are solved concurrently by nEvaluationThreads_ threads
+	bool evaluateScheduleInParallel(int sched);
+
+	// Cache of the evaluations: for each multiset of end-of-week states, the costs of the evaluation demands
+	// without the base cost. The nurses with the same contract and skills are interchangeable in the evaluation
+	// (the preferences are empty), so the key is the sorted list of (contract, skills, state) of the nurses
+	map<vector<vector<int> >, vector<double> > evaluationCache_;
+	vector<vector<int> > evaluationKey(const vector<State>& states);
+	// Store the costs of a complete evaluation in the cache
+	void storeEvaluation(int sched, const vector<double>& evaluationCosts);
+	// Evaluate 1 schedule with the evaluation of identical final states if any (returns false otherwise)
+	bool evaluateScheduleFromCache(int sched);
 	// insert the schedule, for the e valuation demand j and its evaluated costs
 	void insertSolution(int sched, int j, double currentCost=1.0e6, double currentCostGreedy=1.0e6);
 	// Recompute all scores after one schedule evaluation
 	void updateRankingsAndScores(RankingStrategy strategy);
+	// Costs of each schedule for each evaluation demand, as inserted by insertSolution
+	vector<vector<double> > theEvaluationCosts_;
+	// Return true if the evaluation of sched over the first nDemands evaluation demands is dominated by the best schedule
+	bool isDominatedInRace(int sched, int nDemands);
+	// Cost of the evaluation demand j from which sched cannot beat the best schedule anymore (RK_MEAN, withEvaluationCutOff_)
+	double evaluationCutOff(int sched, int j);
+	// Mean cost of each schedule over the evaluation demands with the greedy (-1 if not pre-screened)
+	vector<double> theGreedyScores_;
+	// Scenario of the greedy pre-screen -> only 1 for all the schedules and demands (only its demand and initial states change)
+	// It shares the contracts and positions of pScenario_, so it is not deleted
+	Scenario * pPreScreenScenario_;
+	// Evaluate 1 schedule with the greedy: return false if it is screened out (it then gets high costs)
+	bool preScreenSchedule(int sched);
+	// Log the correlation between the greedy and the full evaluations of the schedules evaluated by both
+	void logFidelityCorrelation();
 	// Getter
 	double valueOfEvaluation(int sched, int evalDemand){return pEvaluationSolvers_[sched][evalDemand]->solutionCost();}
 
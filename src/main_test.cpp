@@ -13,6 +13,7 @@
 #include "MasterProblem.h"
 #include "StochasticSolver.h"
 #include "SubProblem.h"
+#include "LagrangianSolver.h"
 //#include "CbcModeler.h"
 #include "MyTools.h"
 
@@ -21,10 +22,11 @@
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <thread>
 
 //initialize the counter of object
-unsigned int MyObject::s_count = 0;
-unsigned int Rotation::s_count = 0;
+atomic<unsigned int> MyObject::s_count(0);
+atomic<unsigned int> Rotation::s_count(0);
 
 // Function for testing parts of the code (Antoine)
 void testFunction_Antoine(){
@@ -168,6 +170,19 @@ void testFunction_Jeremy(){
    *****************************************/
   //  testCbc(pScen);
 
+   /****************************************
+   * Test the disaggregation of the blocks of identical nurses
+   *****************************************/
+   testRotationFlowDecomposition();
+
+   /****************************************
+   * Test the Lagrangian bound
+   *****************************************/
+   Scenario* pScenLagrangian = initializeScenario("datasets/n005w4/Sc-n005w4.txt",
+      "datasets/n005w4/WD-n005w4-1.txt", "datasets/n005w4/H0-n005w4-0.txt");
+   testLagrangianBound(pScenLagrangian);
+   delete pScenLagrangian;
+
 
    // Display the total time spent in the tests
    //
@@ -646,9 +661,13 @@ double testMultipleWeeksDeterministic(string dataDir, string instanceName,
 double testMultipleWeeksDeterministic(string dataDir, string instanceName,
 	int historyIndex, vector<int> weekIndices, Algorithm algorithm, string outDir, SolverParam current_param) {
 
+	if(algorithm == GENCOL && current_param.portfolioSize_ != 1)
+		return testMultipleWeeksPortfolio(dataDir, instanceName, historyIndex, weekIndices, outDir, current_param);
+
 	Scenario* pScen = initializeMultipleWeeks(dataDir, instanceName, historyIndex, weekIndices);
 
-	Solver* pSolver = setSolverWithInputAlgorithm(pScen, algorithm);
+	//the native branch and price is used to process the nodes in parallel
+	Solver* pSolver = setSolverWithInputAlgorithm(pScen, algorithm, (current_param.nbThreads_ != 1) ? S_CLP : S_BCP);
 	pSolver->solve(current_param);
 
 	// Display the solution
@@ -664,6 +683,81 @@ double testMultipleWeeksDeterministic(string dataDir, string instanceName,
 }
 
 
+/******************************************************************************
+* Solve a deterministic input demand with a portfolio of solvers
+* The solvers use the native branch and price (S_CLP) with one thread each,
+* as BCP cannot be run in several threads of the same process
+******************************************************************************/
+double testMultipleWeeksPortfolio(string dataDir, string instanceName,
+	int historyIndex, vector<int> weekIndices, string outDir, SolverParam param) {
+
+	int nbSolvers = param.portfolioSize_;
+	if(nbSolvers <= 0)
+		nbSolvers = max(1, (int) std::thread::hardware_concurrency());
+
+	//the strategies are cycled through the solvers, and the next cycles wait longer before stopping
+	const vector<SearchStrategy> strategies = {BestFirstSearch, DepthFirstSearch, BreadthFirstSearch, HighestGapFirst};
+	const int nbStrategies = strategies.size();
+
+	SharedIncumbent incumbent;
+	vector<Scenario*> scenarios(nbSolvers);
+	vector<Solver*> solvers(nbSolvers);
+	vector<SolverParam> params(nbSolvers, param);
+	for(int i=0; i<nbSolvers; ++i){
+		//each solver gets its own copy of the data
+		scenarios[i] = initializeMultipleWeeks(dataDir, instanceName, historyIndex, weekIndices);
+		solvers[i] = setSolverWithInputAlgorithm(scenarios[i], GENCOL, S_CLP);
+		((MasterProblem*) solvers[i])->getModel()->setSearchStrategy(strategies[i % nbStrategies]);
+
+		params[i].nbThreads_ = 1;
+		params[i].pricerSeed_ = i;
+		params[i].nbDiveIfMinGap_ = param.nbDiveIfMinGap_ * (1 + i/nbStrategies);
+		params[i].nbDiveIfRelGap_ = param.nbDiveIfRelGap_ * (1 + i/nbStrategies);
+		params[i].pSharedIncumbent_ = &incumbent;
+	}
+
+	vector<std::thread> threads;
+	for(int i=0; i<nbSolvers; ++i)
+		threads.push_back(std::thread([&solvers, &params, &incumbent, i](){
+			solvers[i]->solve(params[i]);
+			//the solver has closed the gap: stop the others
+			if(solvers[i]->getStatus() == OPTIMAL)
+				incumbent.stop();
+		}));
+	for(std::thread& th: threads)
+		th.join();
+
+	//keep the best solution of the portfolio
+	int best = -1;
+	double bestCost = LARGE_SCORE;
+	for(int i=0; i<nbSolvers; ++i){
+		if(solvers[i]->getSolution().empty())
+			continue;
+		double cost = solvers[i]->solutionCost();
+		if(cost < bestCost){
+			bestCost = cost;
+			best = i;
+		}
+	}
+
+	// Display the solution
+	if(best >= 0){
+		vector<Roster> solution = solvers[best]->getSolution();
+		Status status = solvers[best]->getStatus();
+		//the best solution is optimal if any solver has closed the gap
+		if(incumbent.isStopped())
+			status = OPTIMAL;
+		displaySolutionMultipleWeeks(dataDir, instanceName, historyIndex, weekIndices, solution, status, outDir);
+	}
+
+	for(int i=0; i<nbSolvers; ++i){
+		delete solvers[i];
+		delete scenarios[i];
+	}
+
+	return bestCost;
+}
+
 /******************************************************************************
 * Test a solution on multiple weeks
 * In this method, the weeks are solved sequentially without knowledge of future
@@ -774,7 +868,7 @@ pair<double, int> testMultipleWeeksStochastic(string dataDir, string instanceNam
 * Create a solver of the class specified by the input algorithm type
 ******************************************************************************/
 
-Solver* setSolverWithInputAlgorithm(Scenario* pScen, Algorithm algorithm) {
+Solver* setSolverWithInputAlgorithm(Scenario* pScen, Algorithm algorithm, MySolverType solverType) {
 
 	Solver* pSolver;
 	switch(algorithm){
@@ -782,7 +876,7 @@ Solver* setSolverWithInputAlgorithm(Scenario* pScen, Algorithm algorithm) {
 		pSolver = new Greedy(pScen, pScen->pWeekDemand(), pScen->pWeekPreferences(), pScen->pInitialState());
 		break;
 	case GENCOL:
-		pSolver = new MasterProblem(pScen, pScen->pWeekDemand(), pScen->pWeekPreferences(), pScen->pInitialState(), S_BCP);
+		pSolver = new MasterProblem(pScen, pScen->pWeekDemand(), pScen->pWeekPreferences(), pScen->pInitialState(), solverType);
 		break;
 	default:
 		Tools::throwError("The algorithm is not handled yet");
@@ -908,3 +1002,75 @@ void testCbc(Scenario* pScen) {
   Tools::LogOutput outStream(outFile);
   outStream << pMPCbc->solutionToString();
 }
+
+
+/****************************************
+* Test the disaggregation of the blocks of identical nurses
+*****************************************/
+void testRotationFlowDecomposition() {
+
+	// rotation network of 7 days: resting nodes 0 (source) to 6, then working nodes 1 to 7 (sink)
+	const int nbDays = 7, source = 0, sink = 2*nbDays-1;
+	auto workNode = [nbDays](int k) { return nbDays + k - 1; };
+
+	// a block of 2 nurses who must rest at least 2 days: the first one works on days 0-1 and 4-6,
+	// and the second one on days 3-4. Sharing the rotations by first day would give the rotation
+	// of days 3-4 to the first nurse after a single day off.
+	Rotation rot01(0, {1, 1}), rot34(3, {1, 1}), rot46(4, {1, 1, 1});
+	vector<RotationFlowArc> arcs = {
+		RotationFlowArc(source, 2, 1, &rot01), RotationFlowArc(2, workNode(4), 1), RotationFlowArc(workNode(4), sink, 1, &rot46),
+		RotationFlowArc(source, workNode(3), 1), RotationFlowArc(workNode(3), 5, 1, &rot34), RotationFlowArc(5, sink, 1)};
+	vector< vector<Rotation*> > paths = MasterProblem::decomposeRotationFlow(arcs, source, sink, 2);
+
+	int nbRotations = 0;
+	for(vector<Rotation*>& path: paths){
+		for(int r=1; r<path.size(); ++r)
+			if(path[r]->firstDay_ - (path[r-1]->firstDay_ + path[r-1]->length_) < 2)
+				Tools::throwError("A nurse of the block rests less than in the flow between two rotations.");
+		nbRotations += path.size();
+	}
+	if(nbRotations != 3)
+		Tools::throwError("The rotations of the flow are not all shared out among the nurses of the block.");
+
+	std::cout << "# The flow of the block has been decomposed in 2 paths with the rests of the flow" << std::endl;
+}
+
+
+/****************************************
+* Test the Lagrangian bound
+*****************************************/
+void testLagrangianBound(Scenario* pScen) {
+
+	Demand* pDemand = pScen->pWeekDemand();
+	Preferences* pPref = pScen->pWeekPreferences();
+	vector<State>* pStateIni = pScen->pInitialState();
+
+	// root bound of the column generation
+	SolverParam param;
+	param.stopAfterXSolution_ = 0;
+	MasterProblem* pMaster = new MasterProblem(pScen, pDemand, pPref, pStateIni, S_BCP);
+	double rootBound = pMaster->solve(param);
+	delete pMaster;
+
+	// the iterations of a new solver are the same up to the smallest number of iterations,
+	// so the bound cannot decrease with the number of iterations
+	vector<double> bounds;
+	for(int nbIterations: {1, 5, 20, 50}){
+		param.lagrangianIterations_ = nbIterations;
+		LagrangianSolver* pLagrangian = new LagrangianSolver(pScen, pDemand, pPref, pStateIni);
+		double bound = pLagrangian->solve(param);
+		delete pLagrangian;
+
+		std::cout << "# Lagrangian bound after " << nbIterations << " iterations: " << bound
+			<< " (root bound of the column generation: " << rootBound << ")" << std::endl;
+		if(!bounds.empty() && bound < bounds.back() - EPSILON)
+			Tools::throwError("The Lagrangian bound has decreased with more iterations.");
+		if(bound > rootBound + EPSILON)
+			Tools::throwError("The Lagrangian bound exceeds the root bound of the column generation.");
+		bounds.push_back(bound);
+	}
+
+	// the first iteration has null coverage multipliers: the bound must move from the one of the nurses alone
+	if(bounds.back() < bounds.front() + EPSILON)
+		Tools::throwError("The Lagrangian bound has not increased over the subgradient iterations.");
+}
@@ -80,8 +80,16 @@ double testMultipleWeeksDeterministic(string dataDir, string instanceName,
 pair<double, int>  testMultipleWeeksStochastic(string dataDir, string instanceName,
 		int historyIndex, vector<int> weekIndices, StochasticSolverOptions stochasticSolverOptions, string outdir, int seed=-1);
 
+// Solve a deterministic input demand with a portfolio of column generation
+// solvers run in parallel with different search strategies, seeds and dive
+// parameters. They share their best upper bound and the first one to close the
+// gap stops the others.
+double testMultipleWeeksPortfolio(string dataDir, string instanceName,
+	int historyIndex, vector<int> weekIndices, string outDir, SolverParam param);
+
 // Create a solver of the class specified by the input algorithm type
-Solver* setSolverWithInputAlgorithm(Scenario* pScen, Algorithm algorithm);
+// (for GENCOL, the modeler used to solve the master problem can be chosen)
+Solver* setSolverWithInputAlgorithm(Scenario* pScen, Algorithm algorithm, MySolverType solverType = S_BCP);
 
 // When a solution of multiple consecutive weeks is available, load it in a
 // solver for all the weeks and  display the results
@@ -97,3 +105,11 @@ void testRandomDemandGenerator(int nbDemands,string logFile, Scenario* pScen);
 
 // Test the cbc modeler
 void testCbc(Scenario* pScen);
+
+// Test the decomposition of the flow of a block of identical nurses whose rotations alternate:
+// each nurse must get the rests of the flow between its rotations
+void testRotationFlowDecomposition();
+
+// Test the Lagrangian bound: it must increase with the number of subgradient iterations
+// and remain below the root bound of the column generation
+void testLagrangianBound(Scenario* pScen);